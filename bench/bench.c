@@ -0,0 +1,778 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// scheduler micro-benchmarks, built both for the RP2040 and for the host port (see port/host/)
+// each case takes BENCH_SAMPLES timings and prints their min/median/p99/max in cycles and microseconds
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "hardware/sync.h"
+
+#include "kernel_config.h"
+#include "scheduler.h"
+#include "scheduler_internal.h"
+#include "spinlock_internal.h"
+#include "channel.h"
+#include "channel_internal.h"
+
+#if CORE_COUNT < 2
+#error "the benchmarks need both cores"
+#endif
+
+#ifndef BENCH_EXIT_WHEN_DONE
+#define BENCH_EXIT_WHEN_DONE 0  // end the program after the last case (the host port has somewhere to return to)
+#endif
+
+#define BENCH_SAMPLES 1000                  // timings taken by each case
+#define BENCH_SLEEP_SAMPLES 200             // timings taken for each sleep length
+#define BENCH_THROUGHPUT_MESSAGES 10000     // messages sent for each throughput case
+#define BENCH_SMALL_MESSAGE 8               // size of a small message in bytes
+#define BENCH_POLL_US 25                    // how often channel waits used to poll before they blocked
+
+#define BENCH_PWM_SLICE 7   // a pwm slice nothing else uses, left free-running as a cycle counter
+
+#define BENCH_PRIORITY 5
+#define BENCH_DRIVER_PID 20     // runs the cases on core 0
+#define BENCH_PARTNER_PID 21    // answers the driver from core 1
+#define BENCH_YIELD_PID 22      // the other half of a yield ping-pong
+#define BENCH_NOISE_PID 24      // two tasks keeping core 1 busy switching
+#define BENCH_CHILD_PID 32      // the first id of the tasks that are created and destroyed
+#define BENCH_CHILD_IDS 32      // ids to cycle through, as dead tasks hold onto theirs until collected
+#define BENCH_FILLER_PID 100    // the first id of the tasks that fill the queues for the switch decision and sleepers
+#define BENCH_SLEEPERS 200      // tasks sleeping at once for the sleep jitter case
+#define BENCH_SLEEPER_MIN_US 1000   // the shortest a sleeper sleeps for
+#define BENCH_SLEEPER_STEP_US 700   // and how much longer each of the others does
+#define BENCH_SLEEPER_PERIODS 7     // different periods the sleepers are spread over
+#define BENCH_TOP_PRIORITY 255  // the driver's priority while it times switch decisions
+
+/* Commands from the driver to the partner, the first byte of each message */
+#define BENCH_WAKE 1            // answer with the cycles since the stamp in the message
+#define BENCH_ECHO 2            // send the message straight back
+#define BENCH_SINK_COPY 3       // read BENCH_DATA messages with com_channel_read until BENCH_SINK_END
+#define BENCH_SINK_ZERO_COPY 4  // the same, borrowing them instead
+#define BENCH_SINK_LOCKED 9     // the same, reading each under the channel's spinlock as the data path used to
+#define BENCH_DATA 5
+#define BENCH_SINK_END 6        // answer with the number of BENCH_DATA messages read
+#define BENCH_PING_PONG 7       // echo BENCH_ECHO messages, waiting for them by blocking, until anything else comes
+#define BENCH_PING_PONG_POLL 8  // the same, waiting for them by polling every BENCH_POLL_US
+
+typedef struct {
+    uint32_t us;        // the 1 MHz timer
+    uint16_t cycles;    // the pwm counter, which wraps every 65536 cycles
+} bench_stamp_t;
+
+typedef struct {
+    uint8_t command;
+    bench_stamp_t stamp;
+} bench_message_t;
+
+static uint32_t cycles_per_us;
+static uint32_t cycle_window_us;    // spans shorter than this can't have wrapped the pwm counter
+
+static uint32_t samples[BENCH_SAMPLES];
+static uint32_t num_samples;
+
+static uint16_t channel_id;
+
+static volatile bench_stamp_t yield_stamp;
+static volatile uint32_t yield_from;    // the task that took the last stamp
+static volatile bool yield_stop;
+static volatile bool noise_stop;
+static volatile bool sleepers_stop;
+
+static volatile bench_stamp_t child_stamp;
+
+/* Timing */
+
+static void bench_clock_init() {
+    // no divider and the full 16-bit wrap, so it counts every system clock cycle
+    pwm_config config = pwm_get_default_config();
+    pwm_init(BENCH_PWM_SLICE, &config, true);
+
+    // the governor is off for the benchmarks, so the clock stays put
+    cycles_per_us = clock_get_hz(clk_sys) / 1000000;
+    cycle_window_us = 0x10000 / cycles_per_us / 2;
+}
+
+static bench_stamp_t bench_now() {
+    const uint32_t saved_irq = save_and_disable_interrupts();
+
+    bench_stamp_t stamp;
+    stamp.us = time_us_32();
+    stamp.cycles = pwm_get_counter(BENCH_PWM_SLICE);
+
+    restore_interrupts(saved_irq);
+    return stamp;
+}
+
+// the pwm counter is exact but wraps, so longer spans are counted with the timer instead
+static uint32_t bench_cycles_between(const bench_stamp_t from, const bench_stamp_t to) {
+    const uint32_t us = to.us - from.us;
+
+    if (us < cycle_window_us) {
+        return (uint16_t)(to.cycles - from.cycles);
+    }
+
+    return us * cycles_per_us;
+}
+
+static uint32_t bench_cycles_since(const bench_stamp_t from) {
+    return bench_cycles_between(from, bench_now());
+}
+
+/* Reporting */
+
+static void bench_reset() {
+    num_samples = 0;
+}
+
+static void bench_record(const uint32_t cycles) {
+    if (num_samples < BENCH_SAMPLES) {
+        samples[num_samples++] = cycles;
+    }
+}
+
+static int compare_cycles(const void* a, const void* b) {
+    const uint32_t x = *(const uint32_t*)a;
+    const uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+static float cycles_to_us(const uint32_t cycles) {
+    return (float)cycles / (float)cycles_per_us;
+}
+
+static void bench_report(const char* name) {
+    if (num_samples == 0) {
+        printf("%-32s no samples\n", name);
+        return;
+    }
+
+    qsort(samples, num_samples, sizeof(samples[0]), compare_cycles);
+
+    const uint32_t min = samples[0];
+    const uint32_t median = samples[num_samples / 2];
+    const uint32_t p99 = samples[(num_samples - 1) * 99 / 100];
+    const uint32_t max = samples[num_samples - 1];
+
+    printf("%-32s %5lu %9lu %9lu %9lu %9lu  %9.2f %9.2f %9.2f %9.2f\n", name, (unsigned long)num_samples,
+           (unsigned long)min, (unsigned long)median, (unsigned long)p99, (unsigned long)max,
+           cycles_to_us(min), cycles_to_us(median), cycles_to_us(p99), cycles_to_us(max));
+}
+
+static void bench_report_usage(const char* during) {
+    printf("%-32s core 0 %u%%, core 1 %u%%\n", during, get_core_usage(0), get_core_usage(1));
+}
+
+static void bench_report_throughput(const char* name, const uint16_t size, const uint32_t messages,
+                                    const uint32_t elapsed_us) {
+    const uint64_t messages_per_s = (uint64_t)messages * 1000000 / elapsed_us;
+    printf("%-32s %5u B %9llu msgs/s %11llu B/s\n", name, size, (unsigned long long)messages_per_s,
+           (unsigned long long)(messages_per_s * size));
+}
+
+/* Yield Ping-Pong */
+
+// both tasks run this on the same core, each timing from the other's yield to its own return
+static void yield_ping_pong(const uint32_t pid) {
+    while (!yield_stop && num_samples < BENCH_SAMPLES) {
+        // take the other's stamp before our own, and in one go,
+        // so a tick landing in between can't swap in a newer one and make the span negative
+        const uint32_t saved_irq = save_and_disable_interrupts();
+        const uint32_t from = yield_from;
+        const bench_stamp_t stamp = yield_stamp;
+        restore_interrupts(saved_irq);
+
+        const bench_stamp_t now = bench_now();
+
+        if (from != 0 && from != pid) {
+            bench_record(bench_cycles_between(stamp, now));
+        }
+
+        yield_from = pid;
+        yield_stamp = bench_now();
+        task_yield();
+    }
+}
+
+void yield_task(uint32_t pid, uint32_t* signals, char* args) {
+    yield_ping_pong(pid);
+}
+
+void noise_task(uint32_t pid, uint32_t* signals, char* args) {
+    while (!noise_stop) {
+        task_yield();
+    }
+}
+
+// dead tasks keep their ids until the garbage collector runs, so this also frees the id for the next case
+static void bench_wait_for_exit(const uint32_t pid) {
+    while (task_exists(pid)) {
+        task_sleep_ms(1);
+    }
+}
+
+// the median of the samples taken, once `bench_report` has sorted them
+static uint32_t bench_median() {
+    return num_samples == 0 ? 0 : samples[num_samples / 2];
+}
+
+static uint32_t bench_yield(const char* name, const uint32_t partner_pid) {
+    bench_reset();
+    yield_from = 0;
+    yield_stop = false;
+
+    task_add_affinity(yield_task, partner_pid, BENCH_PRIORITY, TASK_CORE(0));
+    yield_ping_pong(BENCH_DRIVER_PID);
+
+    // the partner would carry on stamping into the next case
+    yield_stop = true;
+    bench_wait_for_exit(partner_pid);
+
+    bench_report(name);
+    return bench_median();
+}
+
+// the same ping-pong while core 1 switches as fast as it can.
+// each core only takes its own run queue's lock to switch, so the median should stay where it was
+static void bench_yield_contended(const uint32_t alone_median) {
+    noise_stop = false;
+    task_add_affinity(noise_task, BENCH_NOISE_PID, BENCH_PRIORITY, TASK_CORE(1));
+    task_add_affinity(noise_task, BENCH_NOISE_PID + 1, BENCH_PRIORITY, TASK_CORE(1));
+
+    const uint32_t busy_median = bench_yield("yield ping-pong, core 1 busy", BENCH_YIELD_PID + 1);
+
+    noise_stop = true;
+    bench_wait_for_exit(BENCH_NOISE_PID);
+    bench_wait_for_exit(BENCH_NOISE_PID + 1);
+
+    printf("%-32s %+ld cyc (%+.2f us) median\n", "switch cost of core 1 busy:",
+           (long)busy_median - (long)alone_median, cycles_to_us(busy_median) - cycles_to_us(alone_median));
+}
+
+/* Channels */
+
+static void bench_send(const uint8_t command) {
+    bench_message_t message;
+    message.command = command;
+    message.stamp = bench_now();
+
+    com_channel_write_blocking(channel_id, (uint8_t*)&message, sizeof(message));
+}
+
+static uint32_t bench_receive_word() {
+    uint32_t word = 0;
+    uint16_t read = 0;
+
+    com_channel_read_blocking(channel_id, (uint8_t*)&word, &read, sizeof(word));
+    return word;
+}
+
+static void bench_cross_core_wakeup() {
+    bench_reset();
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        // give the partner time to block on the channel again
+        task_sleep_ms(1);
+
+        bench_send(BENCH_WAKE);
+        bench_record(bench_receive_word());
+    }
+
+    bench_report("cross-core wakeup");
+    bench_report_usage("cpu usage while waking:");
+}
+
+static void bench_round_trip() {
+    bench_reset();
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        const bench_stamp_t start = bench_now();
+
+        bench_send(BENCH_ECHO);
+
+        bench_message_t reply;
+        uint16_t read = 0;
+        com_channel_read_blocking(channel_id, (uint8_t*)&reply, &read, sizeof(reply));
+
+        bench_record(bench_cycles_since(start));
+    }
+
+    bench_report("channel round trip");
+}
+
+// wait for a message the way channel waits did before they blocked: try, and sleep a little if nothing came
+static kelp_error_t bench_read_polling(uint8_t* buffer, uint16_t* read, const uint16_t size) {
+    kelp_error_t error;
+
+    while ((error = com_channel_read(channel_id, buffer, read, size)) == KELP_CHANNEL_EMPTY) {
+        task_sleep_us(BENCH_POLL_US);
+    }
+
+    return error;
+}
+
+// round trips paced a millisecond apart, with both sides waiting for their message by polling or by blocking.
+// the cpu usage afterwards is what the waiting costs while there is nothing to do
+static void bench_ping_pong(const char* name, const bool polling) {
+    bench_reset();
+    bench_send(polling ? BENCH_PING_PONG_POLL : BENCH_PING_PONG);
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        task_sleep_ms(1);
+        const bench_stamp_t start = bench_now();
+
+        bench_send(BENCH_ECHO);
+
+        bench_message_t reply;
+        uint16_t read = 0;
+        if (polling) {
+            bench_read_polling((uint8_t*)&reply, &read, sizeof(reply));
+        }
+        else {
+            com_channel_read_blocking(channel_id, (uint8_t*)&reply, &read, sizeof(reply));
+        }
+
+        bench_record(bench_cycles_since(start));
+    }
+
+    bench_send(BENCH_SINK_END);
+
+    bench_report(name);
+    bench_report_usage("cpu usage while waiting:");
+}
+
+// how the throughput cases move messages
+typedef enum {
+    BENCH_PATH_COPY,
+    BENCH_PATH_ZERO_COPY,
+    BENCH_PATH_LOCKED,      // copying, with both ends taking the channel's spinlock around each message
+} bench_path_t;
+
+// before the data path was lock-free, every write and read copied the message while holding the channel's spinlock,
+// with interrupts off. the lock-free calls can't be made under that lock (waking the other end takes it),
+// so each end copies the message under it first, which puts back the same hold on the same lock
+static void bench_copy_locked(uint8_t* to, const uint8_t* from, const uint16_t size) {
+    const uint32_t saved_irq = channel_spin_lock(channel_id);
+    memcpy(to, from, size);
+    channel_spin_unlock(channel_id, saved_irq);
+}
+
+static void bench_write_locked(const uint8_t* message, const uint16_t size) {
+    static uint8_t staged[CHANNEL_SIZE];
+
+    bench_copy_locked(staged, message, size);
+    com_channel_write_blocking(channel_id, staged, size);
+}
+
+static void bench_read_locked(uint8_t* buffer, uint16_t* read, const uint16_t size) {
+    static uint8_t staged[CHANNEL_SIZE];
+
+    com_channel_read_blocking(channel_id, staged, read, size);
+    bench_copy_locked(buffer, staged, *read);
+}
+
+static void bench_throughput(const char* name, const uint16_t size, const bench_path_t path) {
+    static uint8_t message[CHANNEL_SIZE];
+    memset(message, 0, sizeof(message));
+    message[0] = BENCH_DATA;
+
+    bench_send(path == BENCH_PATH_ZERO_COPY ? BENCH_SINK_ZERO_COPY :
+               path == BENCH_PATH_LOCKED ? BENCH_SINK_LOCKED : BENCH_SINK_COPY);
+
+    const uint32_t start_us = time_us_32();
+
+    for (uint32_t i = 0; i < BENCH_THROUGHPUT_MESSAGES; i++) {
+        if (path == BENCH_PATH_ZERO_COPY) {
+            uint8_t* slot;
+            com_channel_acquire_blocking(channel_id, size, &slot);
+            slot[0] = BENCH_DATA;
+            com_channel_commit(channel_id, size);
+        }
+        else if (path == BENCH_PATH_LOCKED) {
+            bench_write_locked(message, size);
+        }
+        else {
+            com_channel_write_blocking(channel_id, message, size);
+        }
+    }
+
+    bench_send(BENCH_SINK_END);
+    const uint32_t received = bench_receive_word();
+    const uint32_t elapsed_us = time_us_32() - start_us;
+
+    if (received != BENCH_THROUGHPUT_MESSAGES) {
+        printf("%-32s partner got %lu of %u messages\n", name, (unsigned long)received, BENCH_THROUGHPUT_MESSAGES);
+        return;
+    }
+
+    bench_report_throughput(name, size, BENCH_THROUGHPUT_MESSAGES, elapsed_us > 0 ? elapsed_us : 1);
+}
+
+// read BENCH_DATA messages until BENCH_SINK_END, and answer how many came
+static void partner_sink(const bench_path_t path) {
+    static uint8_t buffer[CHANNEL_SIZE];
+    uint32_t count = 0;
+
+    while (true) {
+        uint8_t command;
+
+        if (path == BENCH_PATH_ZERO_COPY) {
+            const uint8_t* message;
+            uint16_t size;
+            com_channel_borrow_blocking(channel_id, &message, &size);
+            command = message[0];
+            com_channel_release(channel_id);
+        }
+        else if (path == BENCH_PATH_LOCKED) {
+            uint16_t read = 0;
+            bench_read_locked(buffer, &read, sizeof(buffer));
+            command = buffer[0];
+        }
+        else {
+            uint16_t read = 0;
+            com_channel_read_blocking(channel_id, buffer, &read, sizeof(buffer));
+            command = buffer[0];
+        }
+
+        if (command != BENCH_DATA) {
+            break;
+        }
+
+        count++;
+    }
+
+    com_channel_write_blocking(channel_id, (uint8_t*)&count, sizeof(count));
+}
+
+// echo BENCH_ECHO messages until anything else comes
+static void partner_ping_pong(const bool polling) {
+    while (true) {
+        bench_message_t message;
+        uint16_t read = 0;
+
+        if (polling) {
+            bench_read_polling((uint8_t*)&message, &read, sizeof(message));
+        }
+        else {
+            com_channel_read_blocking(channel_id, (uint8_t*)&message, &read, sizeof(message));
+        }
+
+        if (message.command != BENCH_ECHO) {
+            return;
+        }
+
+        com_channel_write_blocking(channel_id, (uint8_t*)&message, sizeof(message));
+    }
+}
+
+void partner_task(uint32_t pid, uint32_t* signals, char* args) {
+    uint16_t connected = 0;
+
+    while (connected == 0) {
+        get_connected_channels(&channel_id, &connected, 1);
+        task_yield();
+    }
+
+    while (true) {
+        bench_message_t message;
+        uint16_t read = 0;
+
+        if (com_channel_read_blocking(channel_id, (uint8_t*)&message, &read, sizeof(message)) != KELP_OK) {
+            continue;
+        }
+
+        switch (message.command) {
+            case BENCH_WAKE: {
+                const uint32_t cycles = bench_cycles_since(message.stamp);
+                com_channel_write_blocking(channel_id, (uint8_t*)&cycles, sizeof(cycles));
+                break;
+            }
+
+            case BENCH_ECHO:
+                com_channel_write_blocking(channel_id, (uint8_t*)&message, sizeof(message));
+                break;
+
+            case BENCH_SINK_COPY:
+                partner_sink(BENCH_PATH_COPY);
+                break;
+
+            case BENCH_SINK_ZERO_COPY:
+                partner_sink(BENCH_PATH_ZERO_COPY);
+                break;
+
+            case BENCH_SINK_LOCKED:
+                partner_sink(BENCH_PATH_LOCKED);
+                break;
+
+            case BENCH_PING_PONG:
+            case BENCH_PING_PONG_POLL:
+                partner_ping_pong(message.command == BENCH_PING_PONG_POLL);
+                break;
+
+            default: ;
+        }
+    }
+}
+
+/* Sleep Accuracy */
+
+static void bench_sleep(const char* name, const uint32_t us) {
+    uint32_t early = 0;
+    bench_reset();
+
+    for (uint32_t i = 0; i < BENCH_SLEEP_SAMPLES; i++) {
+        const bench_stamp_t start = bench_now();
+        task_sleep_us(us);
+        const uint32_t cycles = bench_cycles_since(start);
+
+        // how late the task woke up
+        if (cycles < us * cycles_per_us) {
+            early++;
+            bench_record(0);
+        }
+        else {
+            bench_record(cycles - us * cycles_per_us);
+        }
+    }
+
+    bench_report(name);
+
+    if (early > 0) {
+        printf("%-32s %lu woke up early\n", "", (unsigned long)early);
+    }
+}
+
+/* Task Create/Destroy */
+
+// created above the driver's priority on its core, so it runs as soon as it is added
+void child_task(uint32_t pid, uint32_t* signals, char* args) {
+    bench_record(bench_cycles_since(child_stamp));
+
+    child_stamp = bench_now();
+    task_end(0);
+}
+
+static void bench_create_destroy() {
+    static uint32_t create_samples[BENCH_SAMPLES];
+    static uint32_t destroy_samples[BENCH_SAMPLES];
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        const uint32_t pid = BENCH_CHILD_PID + i % BENCH_CHILD_IDS;
+
+        bench_reset();
+        child_stamp = bench_now();
+
+        // the slots of dead tasks only come back after the garbage collector runs
+        while (task_add_affinity(child_task, pid, BENCH_PRIORITY + 1, TASK_CORE(0)) != KELP_OK) {
+            task_sleep_ms(10);
+            child_stamp = bench_now();
+        }
+
+        const uint32_t destroy_cycles = bench_cycles_since(child_stamp);
+
+        create_samples[i] = num_samples > 0 ? samples[0] : 0;
+        destroy_samples[i] = destroy_cycles;
+    }
+
+    memcpy(samples, create_samples, sizeof(samples));
+    num_samples = BENCH_SAMPLES;
+    bench_report("task create to first run");
+
+    memcpy(samples, destroy_samples, sizeof(samples));
+    num_samples = BENCH_SAMPLES;
+    bench_report("task end to parent running");
+}
+
+/* Switch Decision */
+
+// only fills the ready queue, it sits below the driver and is killed before the driver gives up the core
+void filler_task(uint32_t pid, uint32_t* signals, char* args) {
+    task_wait_signals(TASK_SIGUSR2, TASK_WAIT_FOREVER);
+}
+
+// only fills the sleep heap, it goes to sleep for longer than the case takes and is killed before it wakes up
+void long_sleeper_task(uint32_t pid, uint32_t* signals, char* args) {
+    task_sleep_ms(60 * 1000);
+}
+
+// add `count` tasks to the driver's core below it, from BENCH_FILLER_PID, if there is room for them
+static bool bench_add_fillers(const char* name, void (*filler)(uint32_t, uint32_t*, char*), const uint32_t count) {
+    if (MAX_TASKS - num_tasks < count) {
+        printf("%-32s needs MAX_TASKS of at least %lu\n", name, (unsigned long)(num_tasks + count));
+        return false;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        task_add_affinity(filler, BENCH_FILLER_PID + i, 1 + i % (BENCH_PRIORITY - 1), TASK_CORE(0));
+    }
+
+    return true;
+}
+
+static void bench_remove_fillers(const uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        task_signal(BENCH_FILLER_PID + i, TASK_SIGKILL);
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        bench_wait_for_exit(BENCH_FILLER_PID + i);
+    }
+}
+
+// time `get_next_task` by itself, under the same lock PendSV holds
+// the driver outranks everything else on its core while it does, so it is always picked again
+// and nothing has to be switched
+static void bench_decisions(const char* name) {
+    task_set_priority(get_current_task(), BENCH_TOP_PRIORITY);
+    bench_reset();
+
+    for (uint32_t i = 0; i < BENCH_SAMPLES; i++) {
+        const uint32_t saved_irq = run_queue_spin_lock_this_core();
+        const bench_stamp_t start = bench_now();
+
+        get_next_task();
+
+        const uint32_t cycles = bench_cycles_since(start);
+        run_queue_spin_unlock_this_core(saved_irq);
+
+        bench_record(cycles);
+    }
+
+    task_set_priority(get_current_task(), BENCH_PRIORITY);
+    bench_report(name);
+}
+
+// picking the next task with `count` others ready on the core, which should cost the same however many there are
+static void bench_switch_decision(const uint32_t count) {
+    char name[48];
+    snprintf(name, sizeof(name), "switch decision, %lu ready", (unsigned long)count);
+
+    // the fillers are lower than the driver, so they stay in the ready queue without ever running
+    if (bench_add_fillers(name, filler_task, count)) {
+        bench_decisions(name);
+        bench_remove_fillers(count);
+    }
+}
+
+/* Many Sleepers */
+
+// the decision every tick makes with `count` tasks asleep on the core and none of them due,
+// which only looks at the earliest wakeup
+static void bench_tick_with_sleepers(const uint32_t count) {
+    char name[48];
+    snprintf(name, sizeof(name), "switch decision, %lu asleep", (unsigned long)count);
+
+    if (bench_add_fillers(name, long_sleeper_task, count)) {
+        task_sleep_ms(10); // let each of them run, and go to sleep
+        bench_decisions(name);
+        bench_remove_fillers(count);
+    }
+}
+
+// sleeps for its own period over and over, recording how late it woke up each time
+void sleeper_task(uint32_t pid, uint32_t* signals, char* args) {
+    const uint32_t period_us = BENCH_SLEEPER_MIN_US + (pid % BENCH_SLEEPER_PERIODS) * BENCH_SLEEPER_STEP_US;
+
+    while (!sleepers_stop) {
+        const bench_stamp_t start = bench_now();
+        task_sleep_us(period_us);
+        const uint32_t cycles = bench_cycles_since(start);
+        const uint32_t late = cycles > period_us * cycles_per_us ? cycles - period_us * cycles_per_us : 0;
+
+        // every sleeper is on core 1, so keeping interrupts out is enough to share the samples
+        const uint32_t saved_irq = save_and_disable_interrupts();
+        bench_record(late);
+        restore_interrupts(saved_irq);
+    }
+}
+
+// `count` tasks on core 1 sleeping at mixed periods, each wakeup timed for how late it was
+static void bench_sleep_jitter(const uint32_t count) {
+    char name[48];
+    snprintf(name, sizeof(name), "%lu sleepers, late by", (unsigned long)count);
+
+    if (MAX_TASKS - num_tasks < count) {
+        printf("%-32s needs MAX_TASKS of at least %lu\n", name, (unsigned long)(num_tasks + count));
+        return;
+    }
+
+    bench_reset();
+    sleepers_stop = false;
+
+    for (uint32_t i = 0; i < count; i++) {
+        task_add_affinity(sleeper_task, BENCH_FILLER_PID + i, BENCH_PRIORITY, TASK_CORE(1));
+    }
+
+    while (num_samples < BENCH_SAMPLES) {
+        task_sleep_ms(10);
+    }
+
+    sleepers_stop = true;
+    for (uint32_t i = 0; i < count; i++) {
+        bench_wait_for_exit(BENCH_FILLER_PID + i);
+    }
+
+    bench_report(name);
+    bench_report_usage("cpu usage while sleeping:");
+}
+
+/* Driver */
+
+void driver_task(uint32_t pid, uint32_t* signals, char* args) {
+    if (com_channel_request_blocking(BENCH_PARTNER_PID, false, &channel_id) != KELP_OK) {
+        printf("bench: couldn't get a channel to the partner task\n");
+        return;
+    }
+
+    printf("\nclk_sys %lu MHz, %u samples per case\n", (unsigned long)cycles_per_us, BENCH_SAMPLES);
+    printf("%-32s %5s %9s %9s %9s %9s  %9s %9s %9s %9s\n", "case", "n",
+           "min cyc", "med cyc", "p99 cyc", "max cyc", "min us", "med us", "p99 us", "max us");
+
+    bench_yield_contended(bench_yield("yield ping-pong", BENCH_YIELD_PID));
+    bench_cross_core_wakeup();
+    bench_round_trip();
+    bench_ping_pong("ping-pong, polling every 25 us", true);
+    bench_ping_pong("ping-pong, blocking", false);
+    bench_create_destroy();
+    bench_switch_decision(16);
+    bench_switch_decision(64);
+    bench_switch_decision(256);
+    bench_tick_with_sleepers(BENCH_SLEEPERS);
+    bench_sleep("sleep 100 us, late by", 100);
+    bench_sleep("sleep 1 ms, late by", 1000);
+    bench_sleep("sleep 5 ms, late by", 5000);
+    bench_sleep_jitter(BENCH_SLEEPERS);
+
+    printf("\n");
+    bench_throughput("channel copy, small", BENCH_SMALL_MESSAGE, BENCH_PATH_COPY);
+    bench_throughput("channel copy, large", CHANNEL_SIZE, BENCH_PATH_COPY);
+    bench_throughput("channel locked copy, small", BENCH_SMALL_MESSAGE, BENCH_PATH_LOCKED);
+    bench_throughput("channel locked copy, large", CHANNEL_SIZE, BENCH_PATH_LOCKED);
+    bench_throughput("channel zero-copy, small", BENCH_SMALL_MESSAGE, BENCH_PATH_ZERO_COPY);
+    bench_throughput("channel zero-copy, large", CHANNEL_SIZE, BENCH_PATH_ZERO_COPY);
+
+    printf("\nbench: done\n");
+
+#if BENCH_EXIT_WHEN_DONE
+    exit(0);
+#endif
+}
+
+int main() {
+    stdio_init_all();
+    bench_clock_init();
+
+    task_add_affinity(driver_task, BENCH_DRIVER_PID, BENCH_PRIORITY, TASK_CORE(0));
+    task_add_affinity(partner_task, BENCH_PARTNER_PID, BENCH_PRIORITY, TASK_CORE(1));
+
+    kernel_start();
+
+    return 1; // the kernel never gives the core back
+}
@@ -72,20 +72,22 @@ kelp_error_t com_channel_request_blocking(uint32_t with_pid, bool autoFree, uint
 
 /**
  * @brief Disconnect and free a communication channel
+ * Nothing new can start on the channel once this is called, and it is wiped once neither end is still using it,
+ * which a task waits up to @code CHANNEL_BLOCKING_TIMEOUT_MS@endcode for
  * @param channel_id ID if the channel to free
- * @return An error code
+ * @return An error code, KELP_BUSY if an end was still using it (it is left closing, and the kernel finishes freeing it)
  */
 kelp_error_t com_channel_free(uint16_t channel_id);
 
 /**
- * @brief Check if channel is empty and ready to write to
+ * @brief Check if channel has room for a message of up to @code CHANNEL_SIZE@endcode bytes
  * @param channel_id ID of channel
- * @return Either or not the channel is empty and ready to write to
+ * @return Either or not the channel is ready to write to
  */
 bool is_channel_ready_to_write(uint16_t channel_id);
 
 /**
- * @brief Write a buffer of data to a channel
+ * @brief Write a buffer of data to a channel, as one message queued behind any the reader hasn't read yet
  * @param channel_id ID of the channel to write to
  * @param bytes Array of data to write
  * @param size The length of @code bytes@endcode
@@ -98,19 +100,19 @@ kelp_error_t com_channel_write(uint16_t channel_id, const uint8_t* bytes, uint16
  * @param channel_id ID of the channel to write to
  * @param bytes Array of data to write
  * @param size The length of @code bytes@endcode
- * @return An error code
+ * @return An error code, KELP_KILLED if the current task is being killed (it doesn't wait then)
  */
 kelp_error_t com_channel_write_blocking(uint16_t channel_id, const uint8_t* bytes, uint16_t size);
 
 /**
  * @brief Check if channel has data ready to read
  * @param channel_id ID of channel
- * @return Either or not the channel full of new data
+ * @return Either or not the channel has a message waiting
  */
 bool is_channel_ready_to_read(uint16_t channel_id);
 
 /**
- * @brief Read the data from a channel and copy it to a provided buffer
+ * @brief Read the oldest message from a channel and copy it to a provided buffer
  * @param channel_id ID of the channel to read from
  * @param buffer Array to copy data to
  * @param read A pointer to save the amount of data read to
@@ -125,7 +127,7 @@ kelp_error_t com_channel_read(uint16_t channel_id, uint8_t* buffer, uint16_t* re
  * @param buffer Array to copy data to
  * @param read A pointer to save the amount of data read to
  * @param size Size of the provided buffer
- * @return An error code
+ * @return An error code, KELP_KILLED if the current task is being killed (it doesn't wait then)
  */
 kelp_error_t com_channel_read_blocking(uint16_t channel_id, uint8_t* buffer, uint16_t* read, uint16_t size);
 
@@ -148,8 +150,83 @@ kelp_error_t com_channel_read_no_reset(uint16_t channel_id, uint8_t* buffer, uin
  */
 kelp_error_t com_channel_peek(uint16_t channel_id, uint8_t* byte);
 
-void com_channel_wait_until_writable(uint16_t channel_id);
+/**
+ * @brief Lend out a slot in the channel to write a message of up to @code size@endcode bytes into in place
+ * Nothing is sent until @code com_channel_commit@endcode, and only one slot can be lent at a time.
+ * Freeing the channel waits for the slot to be committed or discarded
+ * @param channel_id ID of the channel to write to
+ * @param size The most bytes that will be written to the slot
+ * @param slot A pointer to save the address of the slot to
+ * @return An error code
+ */
+kelp_error_t com_channel_acquire(uint16_t channel_id, uint16_t size, uint8_t** slot);
+
+/**
+ * @brief Lend out a slot in the channel to write a message into in place, but will block until there is room
+ * @param channel_id ID of the channel to write to
+ * @param size The most bytes that will be written to the slot
+ * @param slot A pointer to save the address of the slot to
+ * @return An error code, KELP_KILLED if the current task is being killed (it doesn't wait then)
+ */
+kelp_error_t com_channel_acquire_blocking(uint16_t channel_id, uint16_t size, uint8_t** slot);
+
+/**
+ * @brief Send the slot from @code com_channel_acquire@endcode as a message
+ * The slot must not be touched after this
+ * @param channel_id ID of the channel the slot is from
+ * @param size How many bytes of the slot were filled in (no more than were acquired)
+ * @return An error code
+ */
+kelp_error_t com_channel_commit(uint16_t channel_id, uint16_t size);
+
+/**
+ * @brief Give back the slot from @code com_channel_acquire@endcode without sending anything
+ * @param channel_id ID of the channel the slot is from
+ * @return An error code
+ */
+kelp_error_t com_channel_discard(uint16_t channel_id);
 
-void com_channel_wait_until_readable(uint16_t channel_id);
+/**
+ * @brief Look at the oldest message in a channel where it is, instead of copying it out
+ * It stays in the channel until @code com_channel_release@endcode, and freeing the channel waits for that
+ * @param channel_id ID of the channel to read from
+ * @param message A pointer to save the address of the message to
+ * @param size A pointer to save the length of the message to
+ * @return An error code
+ */
+kelp_error_t com_channel_borrow(uint16_t channel_id, const uint8_t** message, uint16_t* size);
+
+/**
+ * @brief Look at the oldest message in a channel where it is, but will block until there is one
+ * @param channel_id ID of the channel to read from
+ * @param message A pointer to save the address of the message to
+ * @param size A pointer to save the length of the message to
+ * @return An error code, KELP_KILLED if the current task is being killed (it doesn't wait then)
+ */
+kelp_error_t com_channel_borrow_blocking(uint16_t channel_id, const uint8_t** message, uint16_t* size);
+
+/**
+ * @brief Drop the message from @code com_channel_borrow@endcode, making room for the writer
+ * The message must not be touched after this
+ * @param channel_id ID of the channel the message is from
+ * @return An error code
+ */
+kelp_error_t com_channel_release(uint16_t channel_id);
+
+/**
+ * @brief Block the current task until a message of up to @code CHANNEL_SIZE@endcode bytes can be written to the channel \n
+ * Gives up after @code CHANNEL_BLOCKING_TIMEOUT_MS@endcode, or when the channel is freed
+ * @param channel_id ID of the channel
+ * @return KELP_KILLED if the current task is being killed (it doesn't wait then), KELP_OK otherwise, even if it gave up
+ */
+kelp_error_t com_channel_wait_until_writable(uint16_t channel_id);
+
+/**
+ * @brief Block the current task until the channel has data to read \n
+ * Gives up after @code CHANNEL_BLOCKING_TIMEOUT_MS@endcode, or when the channel is freed
+ * @param channel_id ID of the channel
+ * @return KELP_KILLED if the current task is being killed (it doesn't wait then), KELP_OK otherwise, even if it gave up
+ */
+kelp_error_t com_channel_wait_until_readable(uint16_t channel_id);
 
 #endif //CHANNEL_H
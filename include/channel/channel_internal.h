@@ -5,6 +5,7 @@
 #ifndef CHANNEL_INTERNAL_H
 #define CHANNEL_INTERNAL_H
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #include "kernel_config.h"
@@ -14,13 +15,45 @@
 typedef enum {
     CHANNEL_FREE,
     CHANNEL_ALLOCATED,
-    CHANNEL_CONNECTED
+    CHANNEL_CONNECTED,
+    CHANNEL_CLOSING     // being freed, nothing new may start on it and it is wiped once neither end is using it
 } channel_state_t;
 
+#define CHANNEL_HEADER_SIZE 2   // every message in a fifo starts with its length, as 2 bytes
+
+#define CHANNEL_BUFFER_MASK (CHANNEL_BUFFER_SIZE - 1)
+
+#define CHANNEL_PADDING 0xFFFF // a header with this length means the rest of the buffer was skipped
+
+// a message never wraps around the end of the buffer, so in the worst case half the buffer is skipped
+#if CHANNEL_BUFFER_SIZE < 2 * (CHANNEL_SIZE + CHANNEL_HEADER_SIZE + 1)
+#error CHANNEL_BUFFER_SIZE is too small to fit a message of CHANNEL_SIZE
+#endif
+
+#if (CHANNEL_BUFFER_SIZE & CHANNEL_BUFFER_MASK) != 0
+#error CHANNEL_BUFFER_SIZE has to be a power of two
+#endif
+
+/*
+ * A ring buffer of messages going one way through a channel
+ * Messages are stored back to back, each as its length followed by its bytes, 2-byte aligned.
+ * A message is always in one piece so it can be lent out in place,
+ * when it won't fit before the end of the buffer the writer pads out the rest and starts again at the front.
+ * `head` and `tail` count up forever (wrapping at 2^32, which the power-of-two size divides),
+ * and are masked down to an index into `bytes`.
+ */
 typedef struct {
-    uint8_t* bytes;
-    volatile uint8_t full;
-    volatile uint16_t count;
+    uint8_t* bytes;             // CHANNEL_BUFFER_SIZE bytes of ring buffer
+    volatile uint32_t head;     // where the oldest message starts (only the reader moves it)
+    volatile uint32_t tail;     // where the next message goes (only the writer moves it)
+    uint32_t loan;              // where the message being filled in place starts (writer only)
+    uint16_t loan_size;         // how many bytes were acquired for it
+    bool loaned;                // whether the writer has a slot acquired and not committed
+    bool borrowed;              // whether the reader has a message borrowed and not released
+    volatile bool writing;      // the writer is using the buffer, or has a slot acquired (only the writer raises it)
+    volatile bool reading;      // the reader is using the buffer, or has a message borrowed (only the reader raises it)
+    wait_queue_t readers;   // tasks waiting for a message
+    wait_queue_t writers;   // tasks waiting for room
 } channel_fifo_t;
 
 typedef struct {
@@ -43,10 +76,28 @@ kelp_error_t channel_garbage_collect();
 
 kelp_error_t init_channels();
 
+/**
+ * Free a channel without checking the current task owns it (for the kernel, when its owner is gone)
+ * Nothing new can start on it afterwards, and it is wiped once neither end is still using it.
+ * The global channel spinlock and the channel's spinlock must be held
+ * @param channel_id ID of the channel
+ * @return An error code, KELP_BUSY if an end is still using it (it is left closing, call again to finish)
+ */
+kelp_error_t channel_free_no_check(uint16_t channel_id);
+
 bool is_owner_of_channel_no_lock(uint16_t channel_id);
 
 bool is_connected_to_channel_no_lock(uint16_t channel_id);
 
 kelp_error_t get_connected_channels_no_lock(uint16_t* channel_ids, uint16_t* num_connected, uint16_t size);
 
+/**
+ * Block the current task until a message of `size` bytes fits in its side of a channel
+ * Gives up after CHANNEL_BLOCKING_TIMEOUT_MS, or when the channel is freed
+ * @param channel_id ID of the channel
+ * @param size length of the message that has to fit
+ * @return KELP_KILLED if the task is being killed, KELP_OK otherwise (even if it gave up)
+ */
+kelp_error_t channel_wait_for_room(uint16_t channel_id, uint16_t size);
+
 #endif //CHANNEL_INTERNAL_H
@@ -20,7 +20,8 @@
 
 #ifndef MAX_TASKS
 #define MAX_TASKS 16            // max number of tasks the kernel will accommodate
-                                // (include an extra for each core for idle tasks)
+                                // (include an extra for each core for idle tasks, one for the kernel worker,
+                                // one for the timer service with SOFT_TIMERS, and the work queue workers)
 #endif
 
 #ifndef LOOP_TIME
@@ -28,6 +29,12 @@
                                 // (optimal value was found to be between 1-3 ms)
 #endif
 
+#ifndef TICKLESS_IDLE
+#define TICKLESS_IDLE 0         // when a core only has its idle task to run, stop the periodic tick
+                                // and only wake up when the next sleeping task is due
+                                // or another core hands it something to run (saves power)
+#endif
+
 #ifndef USE_GOVERNOR
 #define USE_GOVERNOR 1          // run the cpu frequency governor
 #endif
@@ -50,6 +57,61 @@
 #endif
 #endif
 
+#ifndef DEADLINE_SCHEDULING
+#define DEADLINE_SCHEDULING 1   // allow tasks scheduled by earliest deadline first (see `task_add_deadline`),
+                                // which run ahead of every priority task
+#endif
+
+#ifndef KERNEL_PID_BASE
+#define KERNEL_PID_BASE 0xFFFFFF00      // ids from here up are kept for the tasks `kernel_start` adds, so `task_add_*`
+                                        // refuses them (the idle tasks take the ids below CORE_COUNT)
+#endif
+
+#ifndef KERNEL_WORKER_PID
+#define KERNEL_WORKER_PID KERNEL_PID_BASE   // id of the task that runs housekeeping
+#endif
+
+#ifndef KERNEL_WORKER_PRIORITY
+#define KERNEL_WORKER_PRIORITY 1        // priority of the housekeeping task, the periodic jobs below are handed to it
+                                        // by the tick instead of running in the tick interrupt
+                                        // (stacks that overflowed only grow once it runs, so keep it above busy tasks
+                                        // if they might starve it)
+#endif
+
+#ifndef SOFT_TIMERS
+#define SOFT_TIMERS 1                   // run software timer callbacks (see soft_timer.h) from one service task,
+                                        // instead of a task with its own stack per periodic job
+#endif
+
+#ifndef SOFT_TIMER_PID
+#define SOFT_TIMER_PID (KERNEL_WORKER_PID + 1)  // id of the timer service task
+#endif
+
+#ifndef SOFT_TIMER_PRIORITY
+#define SOFT_TIMER_PRIORITY 6           // priority every timer callback runs at, so keep them short
+#endif
+
+#ifndef WORK_QUEUE
+#define WORK_QUEUE 1                    // let interrupts hand work to a task (see work_queue.h)
+#endif
+
+#ifndef WORK_QUEUE_PER_CORE
+#define WORK_QUEUE_PER_CORE 0           // a worker on each core running what was posted there,
+                                        // instead of one worker for every core
+#endif
+
+#ifndef WORK_QUEUE_PID
+#define WORK_QUEUE_PID (SOFT_TIMER_PID + 1) // id of the (first) work queue worker, per core workers take one each
+#endif
+
+#ifndef WORK_QUEUE_PRIORITY
+#define WORK_QUEUE_PRIORITY 7           // priority posted work runs at
+#endif
+
+#ifndef WORK_QUEUE_SIZE
+#define WORK_QUEUE_SIZE 32              // work items each core can have waiting, must be a power of 2
+#endif
+
 #ifndef SCHEDULER_GARBAGE_COLLECT_PERIOD
 #define SCHEDULER_GARBAGE_COLLECT_PERIOD 101   // run the scheduler garbage collector ever this many ticks
 #endif
@@ -64,14 +126,29 @@
 #define DYNAMIC_STACK 1         // perform dynamic re-allocation of stacks as they grow
 #endif
 
+#ifndef STACK_GUARD_MPU
+#define STACK_GUARD_MPU 0       // keep the bottom STACK_GUARD_WORDS of the running task's stack out of reach with the MPU,
+                                // so an overflow faults the moment it happens instead of being found by polling
+                                // (the task is then grown or suspended like any other overflow)
+                                // (needs STACK_POOL, and takes STACK_GUARD_WORDS out of every stack)
+#endif
+
+#if STACK_GUARD_MPU
+#define STACK_GUARD_WORDS 64    // the smallest region the MPU can protect (256 bytes)
+#endif
+
 #if DYNAMIC_STACK
 #ifndef STARTING_STACK_SIZE
 #define STARTING_STACK_SIZE 2048 // the amount of stack that is initially given to a task
 #endif
 
 #ifndef MIN_STACK_SIZE
+#if STACK_GUARD_MPU
+#define MIN_STACK_SIZE 128      // the minimum amount of stack the scheduler will resize down to (half of it is guard)
+#else
 #define MIN_STACK_SIZE 64       // the minimum amount of stack the scheduler will resize down to
 #endif
+#endif
 
 #ifndef MAX_STACK_SIZE
 #define MAX_STACK_SIZE 16384    // the maximum amount of stack the scheduler will give a task before suspending it
@@ -90,6 +167,23 @@
 #endif
 #endif
 
+#ifndef STACK_POOL
+#define STACK_POOL 1            // take stacks from a fixed pool of power-of-two sized blocks instead of the heap,
+                                // so handing them out and back is quick, bounded and can't fragment the heap
+                                // (stack sizes get rounded up to a power of two, and with DYNAMIC_STACK
+                                // MIN_STACK_SIZE and MAX_STACK_SIZE have to be powers of two)
+#endif
+
+#if STACK_POOL
+#ifndef STACK_POOL_SIZE
+#if DYNAMIC_STACK
+#define STACK_POOL_SIZE 32768   // words set aside for stacks, a multiple of MAX_STACK_SIZE
+#else
+#define STACK_POOL_SIZE (MAX_TASKS * STACK_SIZE) // words set aside for stacks, a multiple of STACK_SIZE
+#endif
+#endif
+#endif
+
 #ifndef STACK_OVERFLOW_THRESHOLD
 #define STACK_OVERFLOW_THRESHOLD 32 // a task will be suspended or have its stack resized
                                     // when it has less than this many words left free in its stack
@@ -98,12 +192,18 @@
 #endif
 
 #ifndef STACK_MONITOR_PERIOD
-#define STACK_MONITOR_PERIOD 7    // perform a stack usage calculation every this many ticks
-                                // can add large overhead to the scheduler which can be roughly calculated:
-                                // MAX_TASKS * STACK_SIZE * 0.0079 ms (or about 2 ms per task)
+#define STACK_MONITOR_PERIOD 1    // carry on with the stack usage calculation every this many ticks
                                 // (this could be set very high if you think your tasks won't need more stack)
                                 // (if you do experience crashes, you can try reducing this,
                                 // but try STACK_OVERFLOW_THRESHOLD first)
+                                // (0 turns it off, which leaves finding overflows to STACK_GUARD_MPU
+                                // and stops stack usage from being measured)
+#endif
+
+#ifndef STACK_MONITOR_BUDGET
+#define STACK_MONITOR_BUDGET 256  // the most stack words looked at each time, the scan carries on from there next time
+                                // so it bounds the time the tick spends on it, however many tasks there are
+                                // (a full pass over every task takes about total stack words / this many runs)
 #endif
 
 #ifndef STACK_FILLER
@@ -130,7 +230,14 @@
 #endif
 
 #ifndef CHANNEL_SIZE
-#define CHANNEL_SIZE 128         // length of each fifo in a communication channel (in bytes) (must be less that the 16-bit integer limit)
+#define CHANNEL_SIZE 128         // largest message that can be sent through a channel at once (in bytes) (must be less that the 16-bit integer limit)
+#endif
+
+#ifndef CHANNEL_BUFFER_SIZE
+#define CHANNEL_BUFFER_SIZE 512  // length of the ring buffer in each direction of a channel (in bytes)
+                                 // every message takes up 2 or 3 bytes more than its length, and is never split
+                                 // around the end, so this has to fit at least two messages of CHANNEL_SIZE
+                                 // (bigger lets writers run further ahead of readers) (must be a power of two)
 #endif
 
 #ifndef CHANNEL_AUTO_FREE_DELAY
@@ -166,14 +273,25 @@
 
 #if PRINT
 #define PRINT_WARNING(msg) printf(msg)
-#define PRINT_DEBUG(msg) printf(msg)
 #else
 #define PRINT_WARNING(msg)
-#define PRINT_DEBUG(msg)
 #endif
 
-#ifndef PROFILE_SCHEDULER
-#define PROFILE_SCHEDULER 0
+#ifndef TRACE
+#define TRACE 0                 // record context switches, wakeups, channel traffic and more
+                                // into a ring buffer per core, to be read out with `trace_read`
+                                // or streamed by `trace_stream_task` (see trace.h)
+#endif
+
+#if TRACE
+#ifndef TRACE_BUFFER_SIZE
+#define TRACE_BUFFER_SIZE 256   // events kept per core, 16 bytes each (must be a power of two)
+#endif
+
+#ifndef TRACE_STREAM_PERIOD_MS
+#define TRACE_STREAM_PERIOD_MS 10 // how often `trace_stream_task` prints what was recorded
+                                  // (it has to keep up with TRACE_BUFFER_SIZE events in that time)
+#endif
 #endif
 
 #ifndef DUMP_STACKS
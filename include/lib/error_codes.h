@@ -6,7 +6,8 @@
 #define KELPOS_LITE_ERROR_CODES_H
 
 
-typedef enum : int32_t {
+// no fixed underlying type (a C23 feature), every value fits an int, which is 32 bits on the RP2040 and the host
+typedef enum {
     KELP_OK = 0,
     KELP_ERROR = -1,
     KELP_MEMORY = -2,
@@ -29,6 +30,7 @@ typedef enum : int32_t {
     KELP_NO_EXIST = -19,
     KELP_BUSY = -20,
     KELP_NOT_SUPPORTED = -21,
+    KELP_KILLED = -22,
 } kelp_error_t;
 
 #define KELP_RETURN_ON_ERROR(error) if ((error) != KELP_OK) {return (error);}
@@ -51,6 +51,7 @@ void governor_init();
 
 /**
  * Iterate the governor
+ * Runs in the kernel worker task, as it sleeps while the voltage settles
  */
 void governor_update();
 
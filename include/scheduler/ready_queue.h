@@ -0,0 +1,83 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef READY_QUEUE_H
+#define READY_QUEUE_H
+
+#include <stdint.h>
+
+typedef struct task_s task_t;
+
+#define READY_QUEUE_LEVELS 256                          // one level for every possible `uint8_t` priority
+#define READY_QUEUE_GROUPS (READY_QUEUE_LEVELS / 32)    // levels are tracked 32 to a bitmap word
+
+/*
+ * A priority-bitmap ready queue
+ * Every priority level has its own circular list of ready tasks,
+ * and two levels of bitmaps track which of those lists are non-empty.
+ * Finding the highest priority ready task is two find-first-sets,
+ * no matter how many tasks there are.
+ */
+typedef struct {
+    uint32_t group_bitmap;                      // bit g is set if any level in group g has tasks
+    uint32_t level_bitmap[READY_QUEUE_GROUPS];  // bit l of word g is set if level (g * 32 + l) has tasks
+    task_t *heads[READY_QUEUE_LEVELS];          // head of each level's circular list (the tail is head->queue_prev)
+    uint32_t count;                             // number of tasks in the queue
+} ready_queue_t;
+
+/**
+ * Empty a ready queue
+ * @param queue the queue to initialize
+ */
+void ready_queue_init(ready_queue_t *queue);
+
+/**
+ * Add a task to the back of its priority level
+ * The task must not already be in a queue
+ * @param queue the queue to add to
+ * @param task the task to add
+ */
+void ready_queue_push(ready_queue_t *queue, task_t *task);
+
+/**
+ * Take a task out of the queue, wherever it is
+ * @param queue the queue the task is in
+ * @param task the task to remove
+ */
+void ready_queue_remove(ready_queue_t *queue, task_t *task);
+
+/**
+ * Get the first task of the highest non-empty priority level, without removing it
+ * @param queue the queue to look into
+ * @return the task, or NULL if the queue is empty
+ */
+task_t *ready_queue_peek(const ready_queue_t *queue);
+
+/**
+ * Get the priority of the highest non-empty level
+ * Safe to call without holding the queue's lock, as long as the result is only used as a hint
+ * @param queue the queue to look into
+ * @return the priority, or -1 if the queue is empty
+ */
+int32_t ready_queue_top_priority(const ready_queue_t *queue);
+
+/**
+ * Get the highest priority task that is allowed to run on a core, without removing it
+ * Unlike `ready_queue_peek` this walks the lists, so it is slower the more tasks are passed over,
+ * but it never looks at a level at or below `min_priority`
+ * @param queue the queue to look into
+ * @param core the core the task has to be allowed on
+ * @param min_priority the task has to be above this priority (-1 for any)
+ * @return the task, or NULL if no task above `min_priority` may run on the core
+ */
+task_t *ready_queue_peek_for_core(const ready_queue_t *queue, uint8_t core, int32_t min_priority);
+
+/**
+ * Remove and return the first task of the highest non-empty priority level
+ * @param queue the queue to take from
+ * @return the task, or NULL if the queue is empty
+ */
+task_t *ready_queue_pop(ready_queue_t *queue);
+
+#endif //READY_QUEUE_H
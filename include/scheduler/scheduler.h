@@ -5,6 +5,7 @@
 #include <stdbool.h>
 
 #include "error_codes.h"
+#include "pico/types.h"
 
 /* Task Signals */
 #define TASK_SIGTERM (1 << 1) // graceful shutdown
@@ -16,11 +17,73 @@
 #define TASK_SIGUSR1 (1 << 7)
 #define TASK_SIGUSR2 (1 << 8)
 
+#define TASK_WAIT_FOREVER UINT64_MAX // a timeout that never runs out
+
+/* Task Affinity */
+#define TASK_CORE(core) ((uint8_t)(1u << (core)))  // affinity mask of a single core
+#define TASK_ANY_CORE 0xFF                          // affinity mask that lets a task run anywhere
+
 /* Basic Scheduler Functions */
 kelp_error_t kernel_start();
 kelp_error_t task_add_args(void (*task_function)(uint32_t, uint32_t*, char*), uint32_t id, char* args, uint8_t priority);
 kelp_error_t task_add(void (*task_function)(uint32_t, uint32_t*, char*), uint32_t id, uint8_t priority);
 
+/**
+ * Add a task that may only run on some cores
+ * @param task_function the function the task runs
+ * @param id the id of the task
+ * @param args a string copied onto the task's stack and handed to it
+ * @param priority the priority of the task (higher is more priority)
+ * @param core_mask the cores the task may run on, such as `TASK_CORE(1)` or `TASK_CORE(0) | TASK_CORE(1)`
+ * @return KELP_OK if the task was added, KELP_NOT_SUPPORTED if the mask has no cores the kernel uses
+ */
+kelp_error_t task_add_args_affinity(void (*task_function)(uint32_t, uint32_t*, char*), uint32_t id, char* args,
+                                    uint8_t priority, uint8_t core_mask);
+kelp_error_t task_add_affinity(void (*task_function)(uint32_t, uint32_t*, char*), uint32_t id, uint8_t priority,
+                               uint8_t core_mask);
+
+/* Deadline Tasks */
+typedef struct {
+    uint32_t periods;           // periods the task finished
+    uint32_t deadline_misses;   // periods it finished after their deadline, or skipped as it was still busy
+    uint32_t budget_overruns;   // periods it ran for longer than its budget
+    uint32_t worst_response_us; // the longest it took from a release to finishing its period
+} task_deadline_stats_t;
+
+/**
+ * Add a task scheduled by earliest deadline first (EDF), which runs ahead of every priority task.
+ * It is released every `period_us`, and should be done with the period `deadline_us` after the release,
+ * which it says by calling `task_wait_next_period`. If it runs for longer than `budget_us` in a period,
+ * it carries on at `priority` among the other tasks until the next one.
+ * Only available with DEADLINE_SCHEDULING
+ * @param task_function the function the task runs
+ * @param id the id of the task
+ * @param period_us how often the task is released
+ * @param budget_us how long it may run each period, or 0 for no limit
+ * @param deadline_us how long after its release it has to be done, usually `period_us`
+ * @param priority the priority it runs at once it is over budget
+ * @param core the core it runs on
+ * @return KELP_OK if the task was added, KELP_NOT_SUPPORTED if the core or the timing doesn't make sense
+ */
+kelp_error_t task_add_deadline(void (*task_function)(uint32_t, uint32_t*, char*), uint32_t id, uint32_t period_us,
+                               uint32_t budget_us, uint32_t deadline_us, uint8_t priority, uint8_t core);
+
+/**
+ * Finish the current period of a deadline task, and sleep until the next one is released.
+ * Periods keep to the task's first release, however long each one took.
+ * If the task is behind by whole periods, they are skipped and counted as deadline misses.
+ * A priority task just yields
+ */
+void task_wait_next_period();
+
+/**
+ * Get how well a deadline task has been keeping up
+ * @param pid the id of the task
+ * @param stats where to put them
+ * @return KELP_OK, KELP_NO_TASK if there is no such task or KELP_WRONG_TYPE if it isn't a deadline task
+ */
+kelp_error_t task_get_deadline_stats(uint32_t pid, task_deadline_stats_t* stats);
+
 // task management
 /**
  * Make the current task sleep for ms milliseconds
@@ -34,6 +97,44 @@ void task_sleep_ms(uint32_t ms);
  */
 void task_sleep_us(uint64_t us);
 
+/**
+ * Make the current task sleep until a point in time
+ * Returns straight away (after a yield) if that time already passed
+ * @param until when to wake up
+ */
+void task_sleep_until(absolute_time_t until);
+
+/* Periodic Tasks */
+typedef struct {
+    uint64_t next_us;   // when the current period ends, in us since boot
+    uint32_t period_us; // the length of a period
+} task_period_t;
+
+/**
+ * Start a run of periods of `period_us`, the first one starting now
+ * @param period the state to set up, kept by the task between `task_periodic_wait`s
+ * @param period_us how long each period is
+ */
+void task_periodic_start(task_period_t* period, uint32_t period_us);
+
+/**
+ * Sleep until the current period ends, for loops that run once a period.
+ * Periods are anchored to the start, so the time spent working (and ticks) never adds up as drift.
+ * If the period already ended, the task sleeps to the end of the next one still ahead,
+ * and the periods that went by are counted as the task's overruns
+ * @param period the state from `task_periodic_start`
+ * @return how many periods were skipped, usually 0
+ */
+uint32_t task_periodic_wait(task_period_t* period);
+
+/**
+ * Get how many periods a task skipped in `task_periodic_wait` because it was late
+ * @param pid the id of the task
+ * @param overruns where to put the count
+ * @return KELP_OK, or KELP_NO_TASK if there is no such task
+ */
+kelp_error_t task_get_overruns(uint32_t pid, uint32_t* overruns);
+
 /**
  * Make the current task yield for at least one scheduler loop
  * Will make room for lower-priority tasks to run be for this one
@@ -68,10 +169,45 @@ bool task_exists(uint32_t pid);
 
 /**
  * Set the signals flags of a task
- * This can not clear signals, but only raise them
+ * This can not clear signals, but only raise them.
+ * A task blocked in `task_wait_signals` for one of them is woken, and preempts whatever it outranks.
+ * The kernel acts on some signals itself:
+ * TASK_SIGKILL ends the task (once it is out of any wait and holds no mutex, until then it runs to get there,
+ * and every wait it is in or starts ends at once, with KELP_KILLED from the blocking calls),
+ * TASK_SIGSTOP takes it off the CPU until TASK_SIGCONT (a sleeping or blocked task stops as it wakes).
+ * The kernel's own tasks (idle tasks, kernel worker, timer service and work queue workers) ignore those three.
+ * Safe to call from an interrupt
  * @param pid The id of the task for the signal to be sent to
  * @param signals a 32-bit integer containing the signals
  */
 void task_signal(uint32_t pid, uint32_t signals);
 
+/**
+ * Block until any of some signals is raised on the current task, or the timeout runs out.
+ * Signals are left raised, see `task_take_signals` to clear them.
+ * A task with TASK_SIGKILL pending doesn't block, even waiting forever
+ * @param mask the signals to wait for
+ * @param timeout_us how long to wait at most, or TASK_WAIT_FOREVER
+ * @return the signals in `mask` that are raised, 0 if the wait timed out, the task is being killed
+ * (unless TASK_SIGKILL is in `mask`) or it was not called from a task
+ */
+uint32_t task_wait_signals(uint32_t mask, uint64_t timeout_us);
+
+/**
+ * Clear some of the current task's signals, returning which of them were raised
+ * @param mask the signals to clear
+ * @return the signals in `mask` that were raised
+ */
+uint32_t task_take_signals(uint32_t mask);
+
+/**
+ * Change which cores a task may run on
+ * A task running on a core it may no longer use moves the next time that core switches it out
+ * @param pid The id of the task
+ * @param core_mask the cores the task may run on, such as `TASK_CORE(1)`
+ * @return KELP_OK if changed, KELP_NO_TASK if there is no such task,
+ * KELP_INVALID_ID for an idle task and KELP_NOT_SUPPORTED if the mask has no cores the kernel uses
+ */
+kelp_error_t task_set_affinity(uint32_t pid, uint8_t core_mask);
+
 #endif //SCHEDULER_H
\ No newline at end of file
@@ -6,16 +6,23 @@
 #define SCHEDULER_INTERNAL_H
 
 #include "error_codes.h"
+#include "scheduler.h"
 #include "pico/types.h"
 #include "kernel_config.h"
 
 #define CORE_NUM get_core_num() // just a macro for ease
 
+#define LOOP_TIME_US ((uint32_t)((LOOP_TIME) * 1000)) // length of a tick in us
+#define SYSTICK_MAX_TICKS 0xFFFFFF                      // SysTick only has a 24-bit counter
+#define TASK_ALL_CORES ((uint8_t)((1u << CORE_COUNT) - 1)) // affinity mask of every core the kernel uses
+
 /* Multicore Signals */
 #define MULTICORE_SIG_UPDATE_SYSTICK 0x53595354     // send to fifo to signal to other cores that
                                                     // systick should be updated
 #define MULTICORE_SIG_ACKNOWLEDGE 0xAC              // send after responding to a signal
                                                     // to signal acknowledgement
+#define MULTICORE_SIG_RESCHEDULE 0x52534348         // send to fifo to make the other core
+                                                    // pick its next task again
 
 typedef enum {
     TASK_FREE,
@@ -25,12 +32,21 @@ typedef enum {
     TASK_SUSPENDED,
     TASK_STACK_OVERFLOWED,
     TASK_WAIT_US,
+    TASK_BLOCKED,
     TASK_YIELDING,
     TASK_ZOMBIE,
-    TASK_DEAD
+    TASK_DEAD,
+    TASK_STOPPED        // stopped by TASK_SIGSTOP until TASK_SIGCONT
 } task_state_t;
 
-typedef struct {
+typedef enum {
+    TASK_QUEUE_NONE,
+    TASK_QUEUE_READY,
+    TASK_QUEUE_SLEEP,
+    TASK_QUEUE_DEADLINE
+} task_queue_t;
+
+typedef struct task_s {
     // --- Stack Properties ---
     uint32_t *stack_pointer;    // Current stack pointer, also points to the top of the stack
     uint32_t *stack;            // Pointer to the stack
@@ -39,21 +55,54 @@ typedef struct {
 
     // --- Task Properties ---
     uint32_t id;                // Task identifier
-    uint8_t priority;           // Task priority (higher is more priority)
+    uint8_t priority;           // Task priority (higher is more priority), raised while it holds a mutex others wait on
+    uint8_t base_priority;      // The priority it was given, which it drops back to
     uint32_t signals;
+    uint32_t signal_mask;       // Signals that wake the task while it is blocked in `task_wait_signals`, 0 otherwise
     uint32_t requested_stack_size;
 
     // --- State Properties ---
     volatile task_state_t state;         // State of the task
     absolute_time_t resume_us;  // When the task will be done sleeping (in absolute time)
+    uint32_t overruns;          // Periods skipped by `task_periodic_wait` as the task was late
+
+    // --- Queue Properties ---
+    struct task_s *queue_next;  // Next task in the ready queue level this task is in
+    struct task_s *queue_prev;  // Previous task in the ready queue level this task is in
+    uint32_t heap_index;        // Where this task is in the sleep heap
+    task_queue_t queue;         // Which queue this task is in
+    struct task_s *wait_next;   // Next task in the wait queue this task is blocked on
+    struct task_s *wait_prev;   // Previous task in the wait queue this task is blocked on
+    struct wait_queue_s *wait_queue; // Which wait queue this task is in, if any
+    struct kelp_mutex_s *held_mutexes; // Mutexes this task holds, linked through their `next_held`
+    struct kelp_mutex_s *blocked_on;   // The mutex this task is waiting for, if any
+    uint32_t wait_bits;         // Event group bits this task is waiting for, then the bits that woke it
+    uint8_t wait_flags;         // How it is waiting for them (see `KELP_EVENT_WAIT_ALL`)
+    uint8_t core;               // Core whose run queue owns this task (moves if another core steals it)
+    uint8_t affinity;           // Mask of the cores this task may run on (see `TASK_CORE`)
+
+#if DEADLINE_SCHEDULING
+    // --- Deadline Properties ---
+    uint32_t period_us;         // How often the task is released, 0 for a priority task
+    uint32_t budget_us;         // How long it may run each period (0 for no limit)
+    uint32_t relative_deadline_us; // How long after its release it has to be done
+    uint64_t release_us;        // When its current period was released
+    uint64_t deadline_us;       // When its current period has to be done by
+    uint32_t budget_used_us;    // How long it ran this period
+    bool throttled;             // Over budget, it runs by its priority until the next period
+    task_deadline_stats_t deadline_stats;
+#endif
 
     // --- System Usage Properties ---
 #if CPU_FANCY_USAGE_MONITORING
     uint32_t us_executing;
+    uint32_t us_executing_on[CORE_COUNT];       // `us_executing`, split by the core it was spent on
 #else
     uint32_t ticks_executing;   // How many ticks this task was seen running
+    uint32_t ticks_executing_on[CORE_COUNT];    // `ticks_executing`, split by the core it was spent on
 #endif
     uint8_t cpu_usage;          // CPU utilization (0 - 100)
+    uint8_t core_usage[CORE_COUNT]; // Share of each core's time spent running this task (0 - 100)
     uint8_t stack_usage;        // Stack utilization (0 - 100)
 #if OPTIMIZE_STACK_MONITORING
     uint8_t stack_recalculate_cooldown; // loops until next stack usage recalculation
@@ -61,9 +110,18 @@ typedef struct {
 #endif
 } task_t;
 
+#include "ready_queue.h"
+#include "task_heap.h"
+#include "wait_queue.h"
+
 typedef struct {
     task_t *current_task;
-    uint32_t current_task_index;
+    ready_queue_t ready_queue;  // tasks ready to run on this core
+    task_heap_t sleep_heap;     // tasks sleeping on this core, ordered by `resume_us`
+#if DEADLINE_SCHEDULING
+    task_heap_t deadline_heap;  // deadline tasks ready on this core, ordered by `deadline_us`
+    uint32_t run_start_us;      // when the running task was switched in, to charge its budget
+#endif
     uint32_t started;
 #if CPU_FANCY_USAGE_MONITORING
     uint32_t us_executing;
@@ -74,23 +132,18 @@ typedef struct {
     uint32_t ticks_idling;
 #endif
     uint64_t ticks_since_start;
+    uint64_t last_tick_us;      // when the SysTick handler last ran
     uint8_t core_usage;
-} scheduler_t;
-
-#ifdef PROFILE_SCHEDULER
-typedef struct {
-    uint64_t start_us;
-    uint64_t end_us;
-    bool ran_cpu_usage;
-    bool ran_stack_usage;
-    bool ran_stack_resize;
-    bool ran_channel_collection;
-    bool ran_schedular_collection;
-    bool ran_governor;
-} scheduler_profile_t;
-
-extern scheduler_profile_t profile;
+#if TICKLESS_IDLE
+    bool tickless;              // SysTick is set to the next wakeup, instead of every tick
+#endif
+#if CORE_COUNT > 1
+    volatile bool signal_acknowledged;  // the other core answered our last signal
 #endif
+#if STACK_GUARD_MPU
+    volatile bool stack_guard_hit;      // the running task faulted on its stack guard, and is due to be switched out
+#endif
+} scheduler_t;
 
 /* Scheduler Variables */
 extern scheduler_t schedulers[CORE_COUNT];
@@ -106,6 +159,48 @@ void scheduler_start_this_core();
 bool scheduler_is_started();
 void set_scheduler_started(bool started);
 
+/**
+ * Change the state of a task, moving it in or out of its core's ready and sleep queues to match.
+ * Tasks that are currently running on a core are left out of the queues,
+ * `get_next_task` files them away when they are switched out.
+ * If the task becomes ready on a core that is idling, that core is told to reschedule.
+ * The task's run queue must be locked (see `task_lock`).
+ * @param task the task to change
+ * @param state the new state
+ */
+void task_set_state(task_t *task, task_state_t state);
+
+/**
+ * Change the priority a task runs at for now, moving it in its core's ready queue to match.
+ * A task that was raised preempts whatever it now outranks, a running task that was lowered makes its core
+ * pick again. The task's run queue must not be locked, it is locked here
+ * @param task the task to change
+ * @param priority the new priority
+ */
+void task_set_priority(task_t *task, uint8_t priority);
+
+/**
+ * Lock the run queue that owns a task, following the task if it migrates to another core meanwhile.
+ * A task's state and queue membership may only change while its run queue is locked.
+ * @param task the task whose run queue should be locked
+ * @return the saved interrupt state, to be handed to `task_unlock`
+ */
+uint32_t task_lock(const task_t *task);
+
+/**
+ * Unlock the run queue locked by `task_lock`
+ * @param task the same task given to `task_lock`
+ * @param saved_irq the interrupt state returned by `task_lock`
+ */
+void task_unlock(const task_t *task, uint32_t saved_irq);
+
+/**
+ * Check if a task is the current task of any core
+ * @param task the task to check
+ * @return whether the task is loaded on a core
+ */
+bool task_is_running(const task_t *task);
+
 void get_next_task();
 void scheduler_raise_pendsv();
 void refresh_systick_on_clock_change();
@@ -0,0 +1,84 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef SOFT_TIMER_H
+#define SOFT_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "error_codes.h"
+#include "kernel_config.h"
+
+/*
+ * Software timers run a callback once (one-shot) or every period (auto-reload),
+ * all from the one timer service task, so a periodic job costs a `kelp_timer_t` instead of a task and its stack.
+ * Armed timers are kept in a list sorted by when they are due, the service task sleeps until the first of them.
+ *
+ * Callbacks run one after the other at SOFT_TIMER_PRIORITY, on the service task's stack, so they should be short
+ * and never block for long (hand longer work to a task, with a semaphore for example).
+ * Starting, stopping and changing timers is safe from anywhere, callbacks and interrupts included.
+ * Only available with SOFT_TIMERS
+ */
+
+typedef struct kelp_timer_s kelp_timer_t;
+typedef void (*kelp_timer_callback_t)(kelp_timer_t *timer, void *arg);
+
+struct kelp_timer_s {
+    kelp_timer_callback_t callback;
+    void *arg;                  // handed to the callback
+    uint32_t period_us;         // how long after being started it is due, and how often after that if it reloads
+    uint64_t expiry_us;         // when it is next due
+    bool auto_reload;           // it goes again every period, instead of once
+    bool active;                // it is in the list of armed timers
+    struct kelp_timer_s *next;  // the next timer due after it
+};
+
+/**
+ * Set up a timer, which isn't armed until it is started
+ * @param timer the timer to set up
+ * @param callback what to run when it is due
+ * @param arg handed to the callback
+ * @param period_us how long after being started it is due, and how often after that if it reloads
+ * @param auto_reload whether it goes again every period, instead of once
+ * @return KELP_OK, or KELP_NOT_SUPPORTED if the period is 0
+ */
+kelp_error_t kelp_timer_init(kelp_timer_t *timer, kelp_timer_callback_t callback, void *arg, uint32_t period_us,
+                             bool auto_reload);
+
+/**
+ * Arm a timer to be due one period from now, starting it over if it already was
+ * @param timer the timer to start
+ * @return KELP_OK
+ */
+kelp_error_t kelp_timer_start(kelp_timer_t *timer);
+
+/**
+ * Disarm a timer, a callback that is already running still finishes
+ * @param timer the timer to stop
+ * @return KELP_OK, or KELP_NOT_SUPPORTED if it wasn't armed
+ */
+kelp_error_t kelp_timer_stop(kelp_timer_t *timer);
+
+/**
+ * Change how often a timer goes, and start it over with the new period
+ * @param timer the timer to change
+ * @param period_us the new period
+ * @return KELP_OK, or KELP_NOT_SUPPORTED if the period is 0
+ */
+kelp_error_t kelp_timer_change_period(kelp_timer_t *timer, uint32_t period_us);
+
+/**
+ * Check if a timer is armed
+ * @param timer the timer to check
+ * @return whether it will go off
+ */
+bool kelp_timer_is_active(const kelp_timer_t *timer);
+
+/**
+ * The timer service task, `kernel_start` adds it with SOFT_TIMER_PID
+ */
+void soft_timer_task(uint32_t pid, uint32_t *signals, char *args);
+
+#endif //SOFT_TIMER_H
@@ -0,0 +1,54 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef STACK_GUARD_H
+#define STACK_GUARD_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kernel_config.h"
+#include "stack_pool.h"
+
+#if STACK_GUARD_MPU
+#if !STACK_POOL
+#error "STACK_GUARD_MPU needs STACK_POOL, as MPU regions have to be aligned to their size and heap stacks aren't"
+#endif
+
+#if STACK_POOL_MIN_BLOCK <= STACK_GUARD_WORDS
+#error "the smallest stack has to be bigger than the STACK_GUARD_WORDS guard below it"
+#endif
+
+#ifndef STACK_GUARD_REGION
+#define STACK_GUARD_REGION 7    // the MPU region used for the guard (of 8)
+#endif
+
+/**
+ * Turn on the MPU of this core, with the default memory map for everything but the guard.
+ * Every core calls this once before running its first task
+ */
+void stack_guard_init();
+
+/**
+ * Move this core's guard to the bottom of a stack, so any access to it faults.
+ * Called by `get_next_task` for every task it switches to
+ * @param stack the stack of the task about to run (aligned to its block, so to the guard too)
+ */
+void stack_guard_set(const uint32_t* stack);
+
+/**
+ * Take this core's guard away, so the task that hit it can be switched out onto its own stack
+ */
+void stack_guard_clear();
+
+/**
+ * Whether a fault looks like the running task ran into its guard,
+ * from its stack pointer being just above the guard with the frame pushed into the room left there
+ * @param stack the running task's stack
+ * @param frame where the fault pushed its exception frame (so the task's stack pointer, less the frame)
+ */
+bool stack_guard_hit(const uint32_t* stack, const uint32_t* frame);
+#endif
+
+#endif //STACK_GUARD_H
@@ -0,0 +1,95 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef STACK_POOL_H
+#define STACK_POOL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "kernel_config.h"
+
+// blocks come in power-of-two sizes (in words) from the smallest stack a task can have to the biggest
+#if DYNAMIC_STACK
+#define STACK_POOL_MIN_BLOCK MIN_STACK_SIZE
+#define STACK_POOL_MAX_BLOCK MAX_STACK_SIZE
+#else
+#define STACK_POOL_MIN_BLOCK STACK_SIZE
+#define STACK_POOL_MAX_BLOCK STACK_SIZE
+#endif
+
+#define STACK_POOL_MAX_CLASSES 16   // block sizes the pool can track, from STACK_POOL_MIN_BLOCK up
+
+#if STACK_POOL
+#if (STACK_POOL_MIN_BLOCK & (STACK_POOL_MIN_BLOCK - 1)) != 0 || (STACK_POOL_MAX_BLOCK & (STACK_POOL_MAX_BLOCK - 1)) != 0
+#error "the smallest and biggest stack sizes must be powers of two to use the stack pool"
+#endif
+
+#if STACK_POOL_SIZE % STACK_POOL_MAX_BLOCK != 0
+#error "STACK_POOL_SIZE must be a multiple of the biggest stack size"
+#endif
+
+#if STACK_POOL_MAX_BLOCK / STACK_POOL_MIN_BLOCK >= (1 << STACK_POOL_MAX_CLASSES)
+#error "too many stack sizes between the smallest and biggest stack for the stack pool"
+#endif
+#endif
+
+typedef struct {
+    uint32_t size;              // words in the pool
+    uint32_t used;              // words handed out as stacks
+    uint32_t high_water;        // the most words that were ever handed out at once
+    uint32_t largest_free;      // words in the biggest stack that could be handed out right now
+                                // (free words outside of it are fragmented)
+    uint32_t allocations;       // stacks handed out
+    uint32_t failed;            // stacks that couldn't be, as no block was big enough
+    uint16_t free_blocks[STACK_POOL_MAX_CLASSES]; // free blocks of STACK_POOL_MIN_BLOCK << i words
+} stack_pool_stats_t;
+
+/**
+ * Take a stack out of the pool, rounded up to the next block size (or from the heap if STACK_POOL is off).
+ * Takes at most one step per block size, as blocks are split in halves (a buddy allocator)
+ * @param words the size wanted, in words
+ * @param block_words set to the size of the stack handed out, which the task may use all of
+ * @return the stack, or NULL if there is no free block big enough
+ */
+uint32_t* stack_pool_alloc(uint32_t words, uint32_t* block_words);
+
+/**
+ * Give a stack back to the pool, merging it with its free neighbour blocks
+ * @param stack a stack from `stack_pool_alloc`
+ */
+void stack_pool_free(uint32_t* stack);
+
+/**
+ * Grow a stack downwards into the free blocks below it, leaving everything already on it where it is.
+ * Takes at most one step per block size, and the new words already hold STACK_FILLER
+ * @param stack the stack from `stack_pool_alloc`, set to its new start if it grew
+ * @param words the size wanted, in words
+ * @param block_words set to the new size of the stack if it grew
+ * @return whether it grew, if not the blocks below it are taken (or the pool is off) and it has to be moved
+ */
+bool stack_pool_grow(uint32_t** stack, uint32_t words, uint32_t* block_words);
+
+/**
+ * Shrink a stack by handing back the bottom of its block, leaving everything above where it is
+ * @param stack the stack from `stack_pool_alloc`, set to its new start if it shrank
+ * @param words the size wanted, in words
+ * @param block_words set to the new size of the stack if it shrank
+ * @return whether it shrank (never with the pool off)
+ */
+bool stack_pool_shrink(uint32_t** stack, uint32_t words, uint32_t* block_words);
+
+/**
+ * @param words a stack size
+ * @return the size of the stack `stack_pool_alloc` would hand out for it
+ */
+uint32_t stack_pool_block_words(uint32_t words);
+
+/**
+ * Get how full and how fragmented the stack pool is
+ * @param stats filled in with the current numbers (all zero if STACK_POOL is off)
+ */
+void stack_pool_get_stats(stack_pool_stats_t* stats);
+
+#endif //STACK_POOL_H
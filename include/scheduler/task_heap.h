@@ -0,0 +1,72 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef TASK_HEAP_H
+#define TASK_HEAP_H
+
+#include <stdint.h>
+
+#include "kernel_config.h"
+
+typedef struct task_s task_t;
+
+/*
+ * A binary min-heap of tasks, ordered by a 64-bit key (usually an absolute time in us)
+ * Each task remembers where it is in the heap,
+ * so it can be taken out from anywhere without searching.
+ */
+typedef struct {
+    uint64_t key;
+    task_t *task;
+} task_heap_node_t;
+
+typedef struct {
+    task_heap_node_t nodes[MAX_TASKS];
+    uint32_t count;
+} task_heap_t;
+
+/**
+ * Empty a heap
+ * @param heap the heap to initialize
+ */
+void task_heap_init(task_heap_t *heap);
+
+/**
+ * Add a task to the heap
+ * The task must not already be in a heap
+ * @param heap the heap to add to
+ * @param task the task to add
+ * @param key the value the task is ordered by (smallest comes out first)
+ */
+void task_heap_push(task_heap_t *heap, task_t *task, uint64_t key);
+
+/**
+ * Take a task out of the heap, wherever it is
+ * @param heap the heap the task is in
+ * @param task the task to remove
+ */
+void task_heap_remove(task_heap_t *heap, task_t *task);
+
+/**
+ * Get the task with the smallest key, without removing it
+ * @param heap the heap to look into
+ * @return the task, or NULL if the heap is empty
+ */
+task_t *task_heap_peek(const task_heap_t *heap);
+
+/**
+ * Get the smallest key in the heap
+ * @param heap the heap to look into
+ * @return the smallest key, or UINT64_MAX if the heap is empty
+ */
+uint64_t task_heap_peek_key(const task_heap_t *heap);
+
+/**
+ * Remove and return the task with the smallest key
+ * @param heap the heap to take from
+ * @return the task, or NULL if the heap is empty
+ */
+task_t *task_heap_pop(task_heap_t *heap);
+
+#endif //TASK_HEAP_H
@@ -0,0 +1,113 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef WAIT_QUEUE_H
+#define WAIT_QUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "pico/types.h"
+#include "error_codes.h"
+
+typedef struct task_s task_t;
+
+/*
+ * A first-in first-out list of tasks blocked on something (a channel, a mutex...)
+ * A wait queue has no lock of its own, it is protected by the lock of whatever it belongs to,
+ * which has to be held for every call below.
+ *
+ * Waiting goes like this:
+ *   lock; while (!condition) { if (task_wait_prepare != KELP_OK) break; unlock; scheduler_raise_pendsv; lock;
+ *                              if (task_wait_finish != KELP_OK) break; } unlock;
+ * so a wakeup between the unlock and the switch is never lost, the task just becomes ready again before it is switched out.
+ * A task with TASK_SIGKILL pending never blocks, it has to get out of every wait to die,
+ * so both calls give back KELP_KILLED for the wait to hand up to whoever called it.
+ */
+typedef struct wait_queue_s {
+    task_t *head;   // longest waiting task
+    task_t *tail;   // most recently added task
+} wait_queue_t;
+
+/**
+ * Empty a wait queue
+ * A zeroed wait queue is also empty
+ * @param queue the queue to initialize
+ */
+void wait_queue_init(wait_queue_t *queue);
+
+/**
+ * Put the current task at the back of a wait queue and mark it blocked
+ * It keeps running until the caller lets go of the queue's lock and raises PendSV
+ * @param queue the queue to wait in
+ * @param until when to give up waiting, or `at_the_end_of_time` to wait forever
+ * @return KELP_OK, or KELP_KILLED if the task is being killed, and wasn't queued as it must not wait
+ */
+kelp_error_t task_wait_prepare(wait_queue_t *queue, absolute_time_t until);
+
+/**
+ * Like `task_wait_prepare`, but the task goes in ahead of every task with a lower priority,
+ * so the queue wakes the most important task first (and the longest waiting among equals).
+ * A queue has to be ordered like this for every task, or for none
+ * @param queue the queue to wait in
+ * @param until when to give up waiting, or `at_the_end_of_time` to wait forever
+ * @return KELP_OK, or KELP_KILLED if the task is being killed, and wasn't queued as it must not wait
+ */
+kelp_error_t task_wait_prepare_by_priority(wait_queue_t *queue, absolute_time_t until);
+
+/**
+ * Move a task waiting in a priority ordered queue to where it belongs after its priority changed.
+ * Nothing happens if it isn't in the queue anymore
+ * @param queue the queue the task is waiting in
+ * @param task the task to move
+ */
+void wait_queue_reorder(wait_queue_t *queue, task_t *task);
+
+/**
+ * Clean up after being switched back in from `task_wait_prepare`
+ * @param queue the same queue given to `task_wait_prepare`
+ * @return KELP_OK if the task was woken up, KELP_TIMEOUT if it gave up because `until` came first,
+ * KELP_KILLED if it was made ready to die without being woken (even when waiting forever)
+ */
+kelp_error_t task_wait_finish(wait_queue_t *queue);
+
+/**
+ * Stop waiting before ever being switched out, because the condition came true after `task_wait_prepare`
+ * For conditions that can change without the queue's lock held (like a lock-free fifo),
+ * which have to be checked again after the task is queued so a wakeup can't slip past it
+ * @param queue the same queue given to `task_wait_prepare`
+ */
+void task_wait_cancel(wait_queue_t *queue);
+
+/**
+ * Wake the task that has been waiting the longest
+ * Tasks that already gave up waiting are dropped along the way
+ * @param queue the queue to wake from
+ * @return whether a task was woken
+ */
+bool wait_queue_wake_one(wait_queue_t *queue);
+
+/**
+ * Take a task out of a wait queue and wake it, wherever it is in the queue
+ * @param queue the queue the task is waiting in
+ * @param task the task to wake
+ * @return whether it was woken, false if it had timed out already
+ */
+bool wait_queue_wake_task(wait_queue_t *queue, task_t *task);
+
+/**
+ * Wake the task at the front of a wait queue, like `wait_queue_wake_one`
+ * @param queue the queue to wake from
+ * @return the task that was woken, or NULL if none was
+ */
+task_t *wait_queue_wake_next(wait_queue_t *queue);
+
+/**
+ * Wake every task in a wait queue
+ * @param queue the queue to wake
+ * @return how many tasks were woken
+ */
+uint32_t wait_queue_wake_all(wait_queue_t *queue);
+
+#endif //WAIT_QUEUE_H
@@ -0,0 +1,62 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef WORK_QUEUE_H
+#define WORK_QUEUE_H
+
+#include <stdint.h>
+
+#include "error_codes.h"
+#include "kernel_config.h"
+
+/*
+ * Deferred work, so an interrupt handler can post what it needs done and return,
+ * and a worker task at WORK_QUEUE_PRIORITY runs it soon after.
+ * Each core posts into a ring of its own, which only interrupts on that core (kept out while posting)
+ * and the one worker draining it ever touch, so posting never spins on a lock held by the other core.
+ * The RP2040's cores have no atomic read-modify-write, this is what lock-free comes down to on them.
+ *
+ * With WORK_QUEUE_PER_CORE each core's work runs on a worker of its own, pinned to that core.
+ * Otherwise one worker runs it all, oldest core first.
+ * Only available with WORK_QUEUE
+ */
+
+#if (WORK_QUEUE_SIZE & (WORK_QUEUE_SIZE - 1)) != 0
+#error "WORK_QUEUE_SIZE must be a power of 2"
+#endif
+
+#if WORK_QUEUE_PER_CORE
+#define WORK_QUEUE_WORKERS CORE_COUNT
+#else
+#define WORK_QUEUE_WORKERS 1
+#endif
+
+typedef void (*work_function_t)(void *arg);
+
+typedef struct {
+    work_function_t function;
+    void *arg;
+} work_item_t;
+
+/**
+ * Post work to be run by a worker task. Safe to call from an interrupt, or a task
+ * @param function what to run
+ * @param arg handed to it
+ * @return KELP_OK if it was posted, KELP_NONE_FREE if this core's ring is full (the work is dropped)
+ */
+kelp_error_t work_queue_post(work_function_t function, void *arg);
+
+/**
+ * Check how much work a core couldn't post as its ring was full
+ * @param core the core to check
+ * @return the work items dropped so far
+ */
+uint32_t work_queue_dropped(uint8_t core);
+
+/**
+ * The work queue worker task, `kernel_start` adds it (one per core with WORK_QUEUE_PER_CORE) from WORK_QUEUE_PID
+ */
+void work_queue_task(uint32_t pid, uint32_t *signals, char *args);
+
+#endif //WORK_QUEUE_H
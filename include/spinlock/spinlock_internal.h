@@ -12,6 +12,9 @@ extern spin_lock_t *spin_lock_scheduler;
 extern spin_lock_t *spin_lock_channel;
 
 extern spin_lock_t *channel_spin_locks[NUM_CHANNEL_SPINLOCKS];
+extern spin_lock_t *run_queue_spin_locks[CORE_COUNT];
+extern spin_lock_t *spin_lock_stack_pool;
+extern spin_lock_t *spin_lock_sync;
 
 void spin_locks_init();
 
@@ -25,6 +28,20 @@ void scheduler_spin_unlock(uint32_t irqs);
 
 void scheduler_spin_unlock_unsafe();
 
+uint32_t run_queue_spin_lock(uint8_t core);
+
+void run_queue_spin_lock_unsafe(uint8_t core);
+
+bool run_queue_spin_try_lock_unsafe(uint8_t core);
+
+void run_queue_spin_unlock(uint8_t core, uint32_t irqs);
+
+void run_queue_spin_unlock_unsafe(uint8_t core);
+
+uint32_t run_queue_spin_lock_this_core();
+
+void run_queue_spin_unlock_this_core(uint32_t irqs);
+
 bool global_channel_spin_locked();
 
 uint32_t global_channel_spin_lock();
@@ -35,6 +52,8 @@ void global_channel_spin_unlock(uint32_t irqs);
 
 void global_channel_spin_unlock_unsafe();
 
+spin_lock_t *get_channel_spin_lock(uint16_t channel_id);
+
 bool channel_spin_locked(uint16_t channel_id);
 
 uint32_t channel_spin_lock(uint16_t channel_id);
@@ -45,4 +64,14 @@ void channel_spin_unlock(uint16_t channel_id, uint32_t irqs);
 
 void channel_spin_unlock_unsafe(uint16_t channel_id);
 
+// the stack pool's lock is taken last, after any other
+uint32_t stack_pool_spin_lock();
+
+void stack_pool_spin_unlock(uint32_t irqs);
+
+// the lock of every mutex, semaphore and event group, taken before any run queue lock
+uint32_t sync_spin_lock();
+
+void sync_spin_unlock(uint32_t irqs);
+
 #endif //SPINLOCK_INTERNAL_H
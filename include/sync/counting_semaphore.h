@@ -0,0 +1,74 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef KELP_COUNTING_SEMAPHORE_H
+#define KELP_COUNTING_SEMAPHORE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "error_codes.h"
+#include "wait_queue.h"
+
+/*
+ * A counting semaphore. Taking it blocks the task while the count is 0, instead of polling.
+ * Giving can be done from anywhere, interrupts included, and wakes the longest waiting task.
+ * Named `kelp_semaphore_t` so it doesn't clash with the pico-sdk's `semaphore_t`.
+ */
+typedef struct {
+    uint32_t count;         // units that can be taken without waiting
+    uint32_t max;           // the count never goes above this
+    wait_queue_t waiters;   // tasks waiting for the count to go above 0
+} kelp_semaphore_t;
+
+// a semaphore starting at `initial`, counting up to `max`
+#define KELP_SEMAPHORE_INIT(initial, max) {(initial), (max), {NULL, NULL}}
+
+/**
+ * Set up a semaphore
+ * @param semaphore the semaphore to initialize
+ * @param initial the count it starts at
+ * @param max the highest the count can go, 1 for a binary semaphore
+ */
+void kelp_semaphore_init(kelp_semaphore_t *semaphore, uint32_t initial, uint32_t max);
+
+/**
+ * Take a unit from a semaphore, blocking for as long as the count is 0
+ * @param semaphore the semaphore to take from
+ * @return KELP_OK once a unit is taken, KELP_KILLED if the task is being killed (it doesn't wait then),
+ * KELP_NOT_SUPPORTED if not called from a task
+ */
+kelp_error_t kelp_semaphore_take(kelp_semaphore_t *semaphore);
+
+/**
+ * Take a unit from a semaphore, giving up if the count stays at 0 for too long
+ * @param semaphore the semaphore to take from
+ * @param timeout_us how long to wait at most
+ * @return KELP_OK once a unit is taken, KELP_TIMEOUT if none was given in time, KELP_KILLED if the task is being killed,
+ * KELP_NOT_SUPPORTED if not called from a task
+ */
+kelp_error_t kelp_semaphore_take_timeout(kelp_semaphore_t *semaphore, uint64_t timeout_us);
+
+/**
+ * Take a unit from a semaphore if there is one, without waiting. Safe to call from an interrupt
+ * @param semaphore the semaphore to take from
+ * @return KELP_OK if a unit was taken, KELP_BUSY if the count is 0
+ */
+kelp_error_t kelp_semaphore_try_take(kelp_semaphore_t *semaphore);
+
+/**
+ * Give a unit back to a semaphore, waking the longest waiting task. Safe to call from an interrupt
+ * @param semaphore the semaphore to give to
+ * @return KELP_OK if it was given, KELP_TOO_BIG if the count is already at its max
+ */
+kelp_error_t kelp_semaphore_give(kelp_semaphore_t *semaphore);
+
+/**
+ * Check how many units a semaphore has
+ * @param semaphore the semaphore to check
+ * @return its count
+ */
+uint32_t kelp_semaphore_get_count(const kelp_semaphore_t *semaphore);
+
+#endif //KELP_COUNTING_SEMAPHORE_H
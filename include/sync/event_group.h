@@ -0,0 +1,85 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef KELP_EVENT_GROUP_H
+#define KELP_EVENT_GROUP_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "error_codes.h"
+#include "wait_queue.h"
+
+/* Event Wait Flags */
+#define KELP_EVENT_WAIT_ANY 0           // wake once any of the bits is set
+#define KELP_EVENT_WAIT_ALL (1 << 0)    // wake once all of the bits are set
+#define KELP_EVENT_CLEAR (1 << 1)       // clear the bits waited for on the way out
+
+/*
+ * 32 event flags tasks can block on, until any or all of the ones they want are set.
+ * Setting bits can be done from anywhere, interrupts included. Every waiter the new bits satisfy is woken
+ * by the same set, before any of them clears what it waited for, so one waiter clearing can't starve another.
+ */
+typedef struct {
+    uint32_t bits;          // the flags that are set
+    wait_queue_t waiters;   // tasks waiting for flags, each with what it waits for in `wait_bits`
+} kelp_event_group_t;
+
+// an event group with no flags set, a zeroed event group is one too
+#define KELP_EVENT_GROUP_INIT {0, {NULL, NULL}}
+
+/**
+ * Set up an event group with no flags set
+ * @param group the event group to initialize
+ */
+void kelp_event_group_init(kelp_event_group_t *group);
+
+/**
+ * Set flags, waking every task waiting for them. Safe to call from an interrupt
+ * @param group the event group
+ * @param bits the flags to set
+ * @return the flags that are set once the woken tasks cleared theirs
+ */
+uint32_t kelp_event_group_set(kelp_event_group_t *group, uint32_t bits);
+
+/**
+ * Clear flags. Safe to call from an interrupt
+ * @param group the event group
+ * @param bits the flags to clear
+ * @return the flags that were set before clearing
+ */
+uint32_t kelp_event_group_clear(kelp_event_group_t *group, uint32_t bits);
+
+/**
+ * Check which flags are set
+ * @param group the event group
+ * @return the flags that are set
+ */
+uint32_t kelp_event_group_get(const kelp_event_group_t *group);
+
+/**
+ * Block until some flags are set
+ * @param group the event group
+ * @param bits the flags to wait for
+ * @param flags `KELP_EVENT_WAIT_ANY` or `KELP_EVENT_WAIT_ALL`, with `KELP_EVENT_CLEAR` to clear them once they are
+ * @param set where to put the flags that were set when the wait ended (may be NULL)
+ * @return KELP_OK once they are set, KELP_KILLED if the task is being killed (it doesn't wait then),
+ * KELP_ERROR if `bits` is 0, KELP_NOT_SUPPORTED if not called from a task
+ */
+kelp_error_t kelp_event_group_wait(kelp_event_group_t *group, uint32_t bits, uint8_t flags, uint32_t *set);
+
+/**
+ * Block until some flags are set, giving up if they aren't in time
+ * @param group the event group
+ * @param bits the flags to wait for
+ * @param flags `KELP_EVENT_WAIT_ANY` or `KELP_EVENT_WAIT_ALL`, with `KELP_EVENT_CLEAR` to clear them once they are
+ * @param timeout_us how long to wait at most
+ * @param set where to put the flags that were set when the wait ended (may be NULL)
+ * @return KELP_OK once they are set, KELP_TIMEOUT if they weren't in time, KELP_KILLED if the task is being killed,
+ * KELP_ERROR if `bits` is 0, KELP_NOT_SUPPORTED if not called from a task
+ */
+kelp_error_t kelp_event_group_wait_timeout(kelp_event_group_t *group, uint32_t bits, uint8_t flags,
+                                           uint64_t timeout_us, uint32_t *set);
+
+#endif //KELP_EVENT_GROUP_H
@@ -0,0 +1,78 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef KELP_MUTEX_H
+#define KELP_MUTEX_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "error_codes.h"
+#include "wait_queue.h"
+
+/*
+ * A lock for tasks, which blocks the tasks waiting for it instead of spinning.
+ * Waiters queue by priority, and whoever holds the mutex runs at the priority of the most important of them
+ * until it lets go (priority inheritance), so a task in the middle can't keep a more important one waiting
+ * by keeping the holder off the CPU. The raise is passed on if the holder is itself waiting on another mutex.
+ *
+ * Mutexes are for tasks only, interrupts can't hold one. They aren't recursive,
+ * and a task has to let go of every mutex it holds before it ends.
+ * Named `kelp_mutex_t` so it doesn't clash with the pico-sdk's `mutex_t`.
+ */
+typedef struct kelp_mutex_s {
+    task_t *owner;                  // the task holding it, or NULL
+    wait_queue_t waiters;           // tasks waiting for it, most important first
+    struct kelp_mutex_s *next_held; // the next mutex held by the same owner
+} kelp_mutex_t;
+
+// a mutex nobody holds, a zeroed mutex is one too
+#define KELP_MUTEX_INIT {NULL, {NULL, NULL}, NULL}
+
+/**
+ * Set up a mutex nobody holds
+ * @param mutex the mutex to initialize
+ */
+void kelp_mutex_init(kelp_mutex_t *mutex);
+
+/**
+ * Take a mutex, blocking for as long as someone else holds it
+ * @param mutex the mutex to take
+ * @return KELP_OK once it is ours, KELP_BUSY if we already hold it, KELP_KILLED if the task is being killed
+ * (it doesn't wait then), KELP_NOT_SUPPORTED if not called from a task
+ */
+kelp_error_t kelp_mutex_lock(kelp_mutex_t *mutex);
+
+/**
+ * Take a mutex, giving up if someone else holds it for too long
+ * @param mutex the mutex to take
+ * @param timeout_us how long to wait at most
+ * @return KELP_OK once it is ours, KELP_TIMEOUT if it wasn't let go of in time,
+ * KELP_BUSY if we already hold it, KELP_KILLED if the task is being killed, KELP_NOT_SUPPORTED if not called from a task
+ */
+kelp_error_t kelp_mutex_lock_timeout(kelp_mutex_t *mutex, uint64_t timeout_us);
+
+/**
+ * Take a mutex if nobody holds it, without waiting
+ * @param mutex the mutex to take
+ * @return KELP_OK if it is ours, KELP_BUSY if it is held (by us or anyone else),
+ * KELP_NOT_SUPPORTED if not called from a task
+ */
+kelp_error_t kelp_mutex_try_lock(kelp_mutex_t *mutex);
+
+/**
+ * Let go of a mutex, handing it straight to the most important task waiting for it
+ * @param mutex the mutex to let go of
+ * @return KELP_OK if it was let go of, KELP_NOT_OWNER if we don't hold it
+ */
+kelp_error_t kelp_mutex_unlock(kelp_mutex_t *mutex);
+
+/**
+ * Check who holds a mutex
+ * @param mutex the mutex to check
+ * @return whether the calling task holds it
+ */
+bool kelp_mutex_is_held(const kelp_mutex_t *mutex);
+
+#endif //KELP_MUTEX_H
@@ -0,0 +1,70 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+
+#include "kernel_config.h"
+
+/* Trace Events */
+// what `a`, `b`, `detail` and `value` hold for each kind of event
+typedef enum {
+    TRACE_START,            // a core started scheduling: a = core
+    TRACE_SWITCH,           // a = task switched out (TRACE_NO_TASK at start), b = task switched in,
+                            // detail = state the old task was left in (why it was switched out)
+    TRACE_STATE,            // a = task, detail = new state, value = old state
+    TRACE_WAKE,             // a = task woken, b = task that woke it (TRACE_NO_TASK from a timer), detail = its core
+    TRACE_CHANNEL_CONNECT,  // value = channel, a = owner, b = partner
+    TRACE_CHANNEL_FREE,     // value = channel
+    TRACE_CHANNEL_WRITE,    // value = channel, a = message size
+    TRACE_CHANNEL_READ,     // value = channel, a = message size
+    TRACE_STACK_RESIZE,     // a = task, b = new stack size, value = old stack size (in words)
+    TRACE_CLOCK,            // a = new system clock, b = old system clock (in kHz)
+    TRACE_HOUSEKEEPING,     // a = how long the kernel worker spent on it (in us), detail = TRACE_HOUSEKEEPING_* that ran
+} trace_type_t;
+
+#define TRACE_NO_TASK 0xFFFFFFFF
+
+#define TRACE_HOUSEKEEPING_STACK_USAGE  (1 << 0)
+#define TRACE_HOUSEKEEPING_CHANNELS     (1 << 1)
+#define TRACE_HOUSEKEEPING_CPU_USAGE    (1 << 2)
+#define TRACE_HOUSEKEEPING_TASKS        (1 << 3)
+#define TRACE_HOUSEKEEPING_GOVERNOR     (1 << 4)
+
+typedef struct {
+    uint32_t time_us;   // the low 32 bits of the timer when it happened
+    uint8_t type;       // a `trace_type_t`
+    uint8_t detail;
+    uint16_t value;
+    uint32_t a;
+    uint32_t b;
+} trace_event_t;
+
+/**
+ * Take the events a core recorded since the last call, oldest first.
+ * Events are recorded into a ring per core, which overwrites the oldest ones once full,
+ * so read them at least every TRACE_BUFFER_SIZE events. Only one task may read a core's events.
+ * @param core the core whose events to read
+ * @param events where to put them
+ * @param max how many fit in `events`
+ * @return how many events were read (always 0 if TRACE is off)
+ */
+uint32_t trace_read(uint8_t core, trace_event_t* events, uint32_t max);
+
+/**
+ * @param core the core to check
+ * @return how many of the core's events were overwritten before they could be read
+ */
+uint32_t trace_dropped(uint8_t core);
+
+/**
+ * A task that prints every traced event to stdout every TRACE_STREAM_PERIOD_MS, as one line each,
+ * for `tools/trace_decode` to turn into a trace for Perfetto or chrome://tracing.
+ * Add it with a low priority, it never returns.
+ */
+void trace_stream_task(uint32_t pid, uint32_t* signals, char* args);
+
+#endif //TRACE_H
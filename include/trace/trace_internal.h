@@ -0,0 +1,36 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef TRACE_INTERNAL_H
+#define TRACE_INTERNAL_H
+
+#include "trace.h"
+
+#if TRACE
+#if (TRACE_BUFFER_SIZE & (TRACE_BUFFER_SIZE - 1)) != 0
+#error "TRACE_BUFFER_SIZE must be a power of two"
+#endif
+
+#define TRACE_BUFFER_MASK (TRACE_BUFFER_SIZE - 1)
+
+// each core only ever writes to its own ring, and readers check they weren't overtaken, so nothing is locked
+typedef struct {
+    trace_event_t events[TRACE_BUFFER_SIZE];
+    volatile uint32_t head;     // events ever recorded, only moved by the core itself
+    uint32_t read;              // events ever read, only moved by the reader
+    uint32_t dropped;
+} trace_buffer_t;
+
+/**
+ * Record an event into this core's ring, safe from tasks and interrupts alike
+ * (use `TRACE_EVENT`, which leaves nothing behind when TRACE is off)
+ */
+void trace_record(uint8_t type, uint8_t detail, uint16_t value, uint32_t a, uint32_t b);
+
+#define TRACE_EVENT(type, detail, value, a, b) trace_record((type), (detail), (value), (a), (b))
+#else
+#define TRACE_EVENT(type, detail, value, a, b)
+#endif
+
+#endif //TRACE_INTERNAL_H
@@ -0,0 +1,82 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// tasks on both emulated cores passing messages through a channel, then checking sleep and exiting
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "scheduler.h"
+#include "channel.h"
+
+#define PRODUCER_PID 10
+#define CONSUMER_PID 11
+#define MESSAGES 10000
+
+void producer_task(uint32_t pid, uint32_t* signals, char* args) {
+    uint16_t channel_id;
+
+    if (com_channel_request_blocking(CONSUMER_PID, false, &channel_id) != KELP_OK) {
+        printf("producer: couldn't get a channel\n");
+        exit(1);
+    }
+
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        if (com_channel_write_blocking(channel_id, (uint8_t*)&i, sizeof(i)) != KELP_OK) {
+            printf("producer: write %u failed\n", i);
+            exit(1);
+        }
+    }
+
+    // wait for the consumer to finish, which ends the program
+    while (true) {
+        task_sleep_ms(100);
+    }
+}
+
+void consumer_task(uint32_t pid, uint32_t* signals, char* args) {
+    uint16_t channel_id;
+    uint16_t connected = 0;
+
+    while (connected == 0) {
+        get_connected_channels(&channel_id, &connected, 1);
+        task_yield();
+    }
+
+    const uint64_t start_us = time_us_64();
+
+    for (uint32_t i = 0; i < MESSAGES; i++) {
+        uint32_t value = 0;
+        uint16_t read = 0;
+
+        kelp_error_t error = com_channel_read_blocking(channel_id, (uint8_t*)&value, &read, sizeof(value));
+        if (error != KELP_OK || value != i) {
+            printf("consumer: expected %u, got %u (error %d)\n", i, value, error);
+            exit(1);
+        }
+    }
+
+    const uint64_t elapsed_us = time_us_64() - start_us;
+    printf("%u messages from core %u to core %u in %llu us\n", MESSAGES, 0, get_core_num(),
+           (unsigned long long)elapsed_us);
+
+    const uint64_t sleep_start_us = time_us_64();
+    task_sleep_ms(20);
+    printf("slept 20 ms in %llu us\n", (unsigned long long)(time_us_64() - sleep_start_us));
+
+    exit(0);
+}
+
+int main() {
+    stdio_init_all();
+
+    task_add_affinity(producer_task, PRODUCER_PID, 5, TASK_CORE(0));
+    task_add_affinity(consumer_task, CONSUMER_PID, 5, TASK_CORE(1));
+
+    kernel_start();
+
+    return 1; // the kernel never gives the core back
+}
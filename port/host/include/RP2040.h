@@ -0,0 +1,30 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the CMSIS device header `RP2040.h`
+
+#ifndef HOST_RP2040_H
+#define HOST_RP2040_H
+
+#include "pico/types.h"
+
+typedef enum {
+    HardFault_IRQn = -13,
+    SVCall_IRQn = -5,
+    PendSV_IRQn = -2,
+    SysTick_IRQn = -1,
+} IRQn_Type;
+
+static inline void NVIC_SetPriority(const IRQn_Type irq, const uint32_t priority) {
+    // the host takes pending exceptions in a fixed order that matches the kernel's priorities
+}
+
+// run a Cortex-M instruction the kernel uses, as far as the host can
+void host_asm(const char *instruction);
+
+// the kernel's handful of inline instructions (`wfi`, `bkpt`) go through `host_asm`
+#define pico_default_asm_volatile(...) host_asm(__VA_ARGS__)
+#define asm(...) host_asm(__VA_ARGS__)
+
+#endif //HOST_RP2040_H
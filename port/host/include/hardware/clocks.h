@@ -0,0 +1,30 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/clocks.h`
+// the clock speed only scales the emulated SysTick, the host runs as fast as it runs
+
+#ifndef HOST_HARDWARE_CLOCKS_H
+#define HOST_HARDWARE_CLOCKS_H
+
+#include "pico/types.h"
+
+enum clock_index {
+    clk_gpout0 = 0,
+    clk_gpout1,
+    clk_gpout2,
+    clk_gpout3,
+    clk_ref,
+    clk_sys,
+    clk_peri,
+    clk_usb,
+    clk_adc,
+    clk_rtc,
+    CLK_COUNT
+};
+
+uint32_t clock_get_hz(enum clock_index clk_index);
+bool set_sys_clock_khz(uint32_t freq_khz, bool required);
+
+#endif //HOST_HARDWARE_CLOCKS_H
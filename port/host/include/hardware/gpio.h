@@ -0,0 +1,35 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/gpio.h`
+// there are no pins, so outputs go nowhere and inputs read low
+
+#ifndef HOST_HARDWARE_GPIO_H
+#define HOST_HARDWARE_GPIO_H
+
+#include "pico/types.h"
+
+#define GPIO_OUT 1
+#define GPIO_IN 0
+
+static inline void gpio_init(const uint gpio) {
+}
+
+static inline void gpio_set_dir(const uint gpio, const bool out) {
+}
+
+static inline void gpio_put(const uint gpio, const bool value) {
+}
+
+static inline bool gpio_get(const uint gpio) {
+    return false;
+}
+
+static inline void gpio_pull_up(const uint gpio) {
+}
+
+static inline void gpio_pull_down(const uint gpio) {
+}
+
+#endif //HOST_HARDWARE_GPIO_H
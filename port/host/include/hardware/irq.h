@@ -0,0 +1,31 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/irq.h`
+// only the SIO FIFO interrupts exist on the host, one per core
+
+#ifndef HOST_HARDWARE_IRQ_H
+#define HOST_HARDWARE_IRQ_H
+
+#include "pico/types.h"
+
+#define SIO_IRQ_PROC0 15
+#define SIO_IRQ_PROC1 16
+
+#define PICO_HIGHEST_IRQ_PRIORITY 0x00
+#define PICO_DEFAULT_IRQ_PRIORITY 0x80
+#define PICO_LOWEST_IRQ_PRIORITY 0xc0
+
+typedef void (*irq_handler_t)(void);
+
+void irq_set_exclusive_handler(uint num, irq_handler_t handler);
+void irq_remove_handler(uint num, irq_handler_t handler);
+void irq_set_enabled(uint num, bool enabled);
+bool irq_is_enabled(uint num);
+
+static inline void irq_set_priority(const uint num, const uint8_t hardware_priority) {
+    // the host takes pending interrupts in a fixed order, SysTick, then the FIFOs, then PendSV
+}
+
+#endif //HOST_HARDWARE_IRQ_H
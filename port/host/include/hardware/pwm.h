@@ -0,0 +1,37 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/pwm.h`
+// only the free-running counter is emulated, counting cycles of the emulated system clock, nothing is output
+
+#ifndef HOST_HARDWARE_PWM_H
+#define HOST_HARDWARE_PWM_H
+
+#include "pico/types.h"
+
+#define NUM_PWM_SLICES 8
+
+typedef struct {
+    uint32_t csr;
+    uint32_t div;   // 8.4 fixed point clock divider, like the DIV register
+    uint32_t top;
+} pwm_config;
+
+static inline pwm_config pwm_get_default_config(void) {
+    const pwm_config config = {0, 1 << 4, 0xffff};
+    return config;
+}
+
+static inline void pwm_config_set_wrap(pwm_config *c, const uint16_t wrap) {
+    c->top = wrap;
+}
+
+static inline void pwm_config_set_clkdiv_int(pwm_config *c, const uint div) {
+    c->div = div << 4;
+}
+
+void pwm_init(uint slice_num, pwm_config *c, bool start);
+uint16_t pwm_get_counter(uint slice_num);
+
+#endif //HOST_HARDWARE_PWM_H
@@ -0,0 +1,32 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/structs/mpu.h`
+// each emulated core has its own MPU registers, which are only memory:
+// nothing is enforced, but the guard the kernel programs can be read back (see `host_core.c`)
+
+#ifndef HOST_HARDWARE_STRUCTS_MPU_H
+#define HOST_HARDWARE_STRUCTS_MPU_H
+
+#include "pico/types.h"
+
+typedef struct {
+    volatile uint32_t type;
+    volatile uint32_t ctrl;
+    volatile uint32_t rnr;      // region number
+    volatile uint32_t rbar;     // region base address
+    volatile uint32_t rasr;     // region attribute and size
+} mpu_hw_t;
+
+#define M0PLUS_MPU_CTRL_PRIVDEFENA_BITS 0x00000004
+#define M0PLUS_MPU_CTRL_ENABLE_BITS 0x00000001
+#define M0PLUS_MPU_RBAR_VALID_BITS 0x00000010
+#define M0PLUS_MPU_RBAR_ADDR_BITS 0xffffff00
+#define M0PLUS_MPU_RASR_SIZE_LSB 1
+#define M0PLUS_MPU_RASR_ENABLE_BITS 0x00000001
+
+mpu_hw_t *host_mpu_hw(void);
+#define mpu_hw (host_mpu_hw())
+
+#endif //HOST_HARDWARE_STRUCTS_MPU_H
@@ -0,0 +1,41 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/structs/systick.h`
+// each emulated core has its own SysTick, counted down by that core's thread (see `host_core.c`)
+
+#ifndef HOST_HARDWARE_STRUCTS_SYSTICK_H
+#define HOST_HARDWARE_STRUCTS_SYSTICK_H
+
+#include "pico/types.h"
+
+typedef struct {
+    volatile uint32_t csr;      // control and status
+    volatile uint32_t rvr;      // reload value
+    volatile uint32_t cvr;      // current value, writing 0 restarts the count
+    volatile uint32_t calib;
+} systick_hw_t;
+
+#define M0PLUS_SYST_CSR_COUNTFLAG_BITS 0x00010000
+#define M0PLUS_SYST_CSR_CLKSOURCE_BITS 0x00000004
+#define M0PLUS_SYST_CSR_TICKINT_BITS 0x00000002
+#define M0PLUS_SYST_CSR_ENABLE_BITS 0x00000001
+
+systick_hw_t *host_systick_hw(void);
+#define systick_hw (host_systick_hw())
+
+/*
+ * The kernel pends PendSV by writing to the ICSR register at `PPB_BASE + M0PLUS_ICSR_OFFSET`.
+ * A store to memory can't be trapped, so on the host the PPB is a block of memory for each core
+ * and reading the PENDSVSET bit value is what pends PendSV (and takes it, if interrupts allow).
+ * The value it reads as is 0, so the store that follows changes nothing.
+ */
+uintptr_t host_ppb_base(void);
+uint32_t host_pend_pendsv(void);
+
+#define PPB_BASE (host_ppb_base())
+#define M0PLUS_ICSR_OFFSET 0x0000ed04
+#define M0PLUS_ICSR_PENDSVSET_BITS (host_pend_pendsv())
+
+#endif //HOST_HARDWARE_STRUCTS_SYSTICK_H
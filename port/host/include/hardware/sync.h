@@ -0,0 +1,143 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/sync.h`
+// spinlocks are words of memory taken with atomics instead of the SIO's lock registers,
+// and "interrupts" are the emulated ones of the core the calling thread is running on (see `host_port.h`)
+
+#ifndef HOST_HARDWARE_SYNC_H
+#define HOST_HARDWARE_SYNC_H
+
+#include "pico/types.h"
+
+typedef volatile uint32_t spin_lock_t;
+
+#define NUM_CORES 2
+#define NUM_SPIN_LOCKS 32
+
+#define PICO_SPINLOCK_ID_IRQ 9
+#define PICO_SPINLOCK_ID_TIMER 10
+#define PICO_SPINLOCK_ID_HARDWARE_CLAIM 11
+#define PICO_SPINLOCK_ID_RAND 12
+#define PICO_SPINLOCK_ID_OS1 14
+#define PICO_SPINLOCK_ID_OS2 15
+#define PICO_SPINLOCK_ID_STRIPED_FIRST 16
+#define PICO_SPINLOCK_ID_STRIPED_LAST 23
+#define PICO_SPINLOCK_ID_CLAIM_FREE_FIRST 24
+#define PICO_SPINLOCK_ID_CLAIM_FREE_LAST 31
+
+// wait for an interrupt, see `host_wfi`
+void __wfi(void);
+
+// no events to wait for between host threads, just tell the cpu we are spinning
+static inline void __wfe(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile ("yield");
+#endif
+}
+
+static inline void __sev(void) {
+}
+
+static inline void __nop(void) {
+}
+
+static inline void __dmb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void __dsb(void) {
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void __isb(void) {
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+}
+
+static inline void __mem_fence_acquire(void) {
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+}
+
+static inline void __mem_fence_release(void) {
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+uint get_core_num(void);
+
+uint32_t save_and_disable_interrupts(void);
+void restore_interrupts(uint32_t status);
+
+static inline void restore_interrupts_from_disabled(const uint32_t status) {
+    restore_interrupts(status);
+}
+
+spin_lock_t *spin_lock_instance(uint lock_num);
+
+static inline uint spin_lock_get_num(spin_lock_t *lock) {
+    return (uint)(lock - spin_lock_instance(0));
+}
+
+/*
+ * Tasks are usually added before `kernel_start` sets up the kernel's spinlocks, so they are still NULL.
+ * On the RP2040 address 0 is boot ROM, which reads as taken-by-us and ignores writes,
+ * so a NULL spinlock always locks straight away, and the host does the same.
+ */
+static inline void spin_lock_unsafe_blocking(spin_lock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    while (__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE)) {
+        while (__atomic_load_n(lock, __ATOMIC_RELAXED)) {
+            __wfe();
+        }
+    }
+}
+
+static inline bool spin_try_lock_unsafe(spin_lock_t *lock) {
+    if (lock == NULL) {
+        return true;
+    }
+
+    return !__atomic_exchange_n(lock, 1, __ATOMIC_ACQUIRE);
+}
+
+static inline void spin_unlock_unsafe(spin_lock_t *lock) {
+    if (lock == NULL) {
+        return;
+    }
+
+    __atomic_store_n(lock, 0, __ATOMIC_RELEASE);
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *lock) {
+    const uint32_t saved_irq = save_and_disable_interrupts();
+    spin_lock_unsafe_blocking(lock);
+    return saved_irq;
+}
+
+static inline void spin_unlock(spin_lock_t *lock, const uint32_t saved_irq) {
+    spin_unlock_unsafe(lock);
+    restore_interrupts(saved_irq);
+}
+
+static inline bool is_spin_locked(spin_lock_t *lock) {
+    return lock != NULL && __atomic_load_n(lock, __ATOMIC_RELAXED) != 0;
+}
+
+static inline spin_lock_t *spin_lock_init(const uint lock_num) {
+    spin_lock_t *lock = spin_lock_instance(lock_num);
+    spin_unlock_unsafe(lock);
+    return lock;
+}
+
+void spin_lock_claim(uint lock_num);
+void spin_lock_claim_mask(uint32_t lock_num_mask);
+void spin_lock_unclaim(uint lock_num);
+int spin_lock_claim_unused(bool required);
+bool spin_lock_is_claimed(uint lock_num);
+
+#endif //HOST_HARDWARE_SYNC_H
@@ -0,0 +1,29 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/timer.h`
+// the timer counts microseconds of the host's monotonic clock since the program started
+
+#ifndef HOST_HARDWARE_TIMER_H
+#define HOST_HARDWARE_TIMER_H
+
+#include "pico/types.h"
+
+uint64_t time_us_64(void);
+
+static inline uint32_t time_us_32(void) {
+    return (uint32_t)time_us_64();
+}
+
+void busy_wait_us(uint64_t delay_us);
+
+static inline void busy_wait_us_32(const uint32_t delay_us) {
+    busy_wait_us(delay_us);
+}
+
+static inline void busy_wait_ms(const uint32_t delay_ms) {
+    busy_wait_us((uint64_t)delay_ms * 1000);
+}
+
+#endif //HOST_HARDWARE_TIMER_H
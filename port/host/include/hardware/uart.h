@@ -0,0 +1,36 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `hardware/uart.h`
+// the host prints to stdout instead, so the uarts are never enabled
+
+#ifndef HOST_HARDWARE_UART_H
+#define HOST_HARDWARE_UART_H
+
+#include "pico/types.h"
+
+typedef struct {
+    volatile uint32_t ibrd;
+    volatile uint32_t fbrd;
+} uart_hw_t;
+
+typedef struct uart_inst uart_inst_t;
+
+#define uart0 ((uart_inst_t *)0)
+#define uart1 ((uart_inst_t *)1)
+
+uart_hw_t *uart_get_hw(uart_inst_t *uart);
+
+static inline bool uart_is_enabled(uart_inst_t *uart) {
+    return false;
+}
+
+static inline uint uart_set_baudrate(uart_inst_t *uart, const uint baudrate) {
+    return baudrate;
+}
+
+static inline void uart_tx_wait_blocking(uart_inst_t *uart) {
+}
+
+#endif //HOST_HARDWARE_UART_H
@@ -0,0 +1,125 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+/*
+ * Host port internals
+ *
+ * The kernel runs on Linux with one thread per emulated core, plus one thread per task slot.
+ * A core thread starts its scheduler like core 0 and core 1 do on the RP2040, and then counts down its SysTick.
+ * Each task runs on its own thread, and only the thread a core is running (its "holder") ever moves:
+ * a context switch hands the core to the next task's thread and parks the old one.
+ *
+ * Exceptions (SysTick, the inter-core FIFO interrupt, and PendSV) are flags pending on a core.
+ * The holder takes them whenever its emulated interrupts are enabled,
+ * straight away if it pended them itself, or when another thread pokes it with HOST_INTERRUPT_SIGNAL.
+ */
+
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <setjmp.h>
+#include <signal.h>
+
+#include "hardware/irq.h"
+#include "hardware/structs/mpu.h"
+#include "hardware/structs/systick.h"
+#include "hardware/sync.h"
+#include "pico/multicore.h"
+#include "kernel_config.h"
+
+#define HOST_INTERRUPT_SIGNAL SIGUSR1   // pokes a core's holder to take its pending exceptions
+
+#define HOST_PENDING_SYSTICK (1u << 0)
+#define HOST_PENDING_FIFO (1u << 1)
+#define HOST_PENDING_PENDSV (1u << 2)
+
+// where registers are in the starting frame `task_add` builds, counted in words up from `stack_pointer`
+#define HOST_FRAME_R3 11
+#define HOST_FRAME_R12 12
+#define HOST_FRAME_PC 14
+
+#define HOST_FRAME_CLAIMED 0x484F5354   // written over R12 once a thread has started the task ("HOST")
+
+#define HOST_DEFAULT_CLOCK_KHZ 125000   // what the emulated clk_sys starts at, like the RP2040
+
+// the thread a task slot runs on
+typedef struct host_thread_s {
+    pthread_t thread;
+    sem_t go;                   // posted to hand this thread a core
+    volatile uint8_t core;      // which core it was handed
+    volatile bool fresh;        // a new task was added to the slot, start over from `start`
+    sigjmp_buf start;
+} host_thread_t;
+
+typedef struct {
+    volatile uint32_t pending;              // exceptions waiting to be taken (HOST_PENDING_*)
+    host_thread_t* volatile holder;         // the task thread this core is running, NULL until it starts
+    volatile bool running;                  // whether the scheduler has started here
+
+    systick_hw_t systick;
+    uint32_t icsr;                          // the one word of the PPB the kernel writes to
+    mpu_hw_t mpu;
+
+    spin_lock_t fifo_lock;                  // guards the FIFO into this core
+    uint32_t fifo[SIO_FIFO_DEPTH];
+    uint8_t fifo_head;
+    volatile uint8_t fifo_count;
+    volatile bool fifo_irq_enabled;
+    irq_handler_t fifo_handler;
+} host_core_t;
+
+extern host_core_t host_cores[CORE_COUNT];
+extern host_thread_t host_threads[MAX_TASKS];
+
+// per thread state, the part of a Cortex-M0+ the kernel cares about
+extern __thread volatile uint8_t host_this_core;            // the core this thread is on
+extern __thread host_thread_t* host_this_thread;            // NULL for core threads
+extern __thread volatile bool host_holding;                 // whether its core is running this thread
+extern __thread volatile bool host_in_exception;            // handler mode
+extern __thread volatile uint32_t host_primask;             // 1 when interrupts are disabled
+
+/**
+ * Take every exception pending on this thread's core, if it is running the core with interrupts enabled
+ * This may hand the core to another thread and only come back when this thread is switched in again (on any core)
+ */
+void host_take_interrupts(void);
+
+/**
+ * Pend an exception on a core, and get its holder to take it
+ * @param core the core to pend it on
+ * @param pending which exception (HOST_PENDING_*)
+ */
+void host_pend(host_core_t* core, uint32_t pending);
+
+/**
+ * Wait for an interrupt, then take it
+ */
+void host_wfi(void);
+
+/**
+ * Park this task thread until a core is handed back to it
+ * Does not return if a new task was added to its slot in the meantime, that one starts over instead
+ * @param self this thread
+ */
+void host_wait_for_core(host_thread_t* self);
+
+/**
+ * Run this core's SysTick forever, after handing its first task to a task thread
+ * This is where a core thread goes when its scheduler starts
+ */
+void host_core_run(void) __attribute__((noreturn));
+
+/**
+ * Start the task threads, before anything else runs
+ */
+void host_threads_init(void);
+
+/* Kernel functions the port calls, that are reached from assembly on the RP2040 */
+void SysTick_Handler(void);
+void PendSV_Handler(void);
+void task_return();
+
+#endif //HOST_PORT_H
@@ -0,0 +1,27 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `pico/multicore.h`
+// core 1 is a thread, and each core's inter-core FIFO is a queue guarded by that core's mutex
+
+#ifndef HOST_PICO_MULTICORE_H
+#define HOST_PICO_MULTICORE_H
+
+#include "pico/types.h"
+
+#define SIO_FIFO_DEPTH 8 // how many words a FIFO holds, like the SIO's
+
+void multicore_reset_core1(void);
+void multicore_launch_core1(void (*entry)(void));
+
+bool multicore_fifo_rvalid(void);
+bool multicore_fifo_wready(void);
+void multicore_fifo_push_blocking(uint32_t data);
+bool multicore_fifo_push_timeout_us(uint32_t data, uint64_t timeout_us);
+uint32_t multicore_fifo_pop_blocking(void);
+bool multicore_fifo_pop_timeout_us(uint64_t timeout_us, uint32_t *out);
+void multicore_fifo_drain(void);
+void multicore_fifo_clear_irq(void);
+
+#endif //HOST_PICO_MULTICORE_H
@@ -0,0 +1,16 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `pico/stdio.h`, stdio goes to the terminal
+
+#ifndef HOST_PICO_STDIO_H
+#define HOST_PICO_STDIO_H
+
+#include <stdio.h>
+
+#include "pico/types.h"
+
+bool stdio_init_all(void);
+
+#endif //HOST_PICO_STDIO_H
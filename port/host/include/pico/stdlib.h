@@ -0,0 +1,23 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `pico/stdlib.h`
+
+#ifndef HOST_PICO_STDLIB_H
+#define HOST_PICO_STDLIB_H
+
+#include "pico/types.h"
+#include "pico/time.h"
+#include "pico/stdio.h"
+#include "hardware/gpio.h"
+#include "hardware/uart.h"
+
+#ifndef PICO_DEFAULT_LED_PIN
+#define PICO_DEFAULT_LED_PIN 25
+#endif
+
+static inline void tight_loop_contents(void) {
+}
+
+#endif //HOST_PICO_STDLIB_H
@@ -0,0 +1,64 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `pico/time.h`
+
+#ifndef HOST_PICO_TIME_H
+#define HOST_PICO_TIME_H
+
+#include "pico/types.h"
+#include "hardware/timer.h"
+
+extern const absolute_time_t at_the_end_of_time;
+extern const absolute_time_t nil_time;
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+static inline uint32_t to_ms_since_boot(const absolute_time_t t) {
+    return (uint32_t)(t / 1000);
+}
+
+static inline absolute_time_t delayed_by_us(const absolute_time_t t, const uint64_t us) {
+    const uint64_t delayed = t + us;
+    return (delayed < t) ? at_the_end_of_time : delayed;
+}
+
+static inline absolute_time_t delayed_by_ms(const absolute_time_t t, const uint32_t ms) {
+    return delayed_by_us(t, (uint64_t)ms * 1000);
+}
+
+static inline absolute_time_t make_timeout_time_us(const uint64_t us) {
+    return delayed_by_us(get_absolute_time(), us);
+}
+
+static inline absolute_time_t make_timeout_time_ms(const uint32_t ms) {
+    return delayed_by_ms(get_absolute_time(), ms);
+}
+
+static inline int64_t absolute_time_diff_us(const absolute_time_t from, const absolute_time_t to) {
+    return (int64_t)(to - from);
+}
+
+static inline bool is_at_the_end_of_time(const absolute_time_t t) {
+    return t == at_the_end_of_time;
+}
+
+static inline bool is_nil_time(const absolute_time_t t) {
+    return t == nil_time;
+}
+
+static inline bool time_reached(const absolute_time_t t) {
+    return time_us_64() >= t;
+}
+
+// these sleep the whole emulated core, like they do on the RP2040 (tasks should use `task_sleep_*`)
+void sleep_us(uint64_t us);
+
+static inline void sleep_ms(const uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+#endif //HOST_PICO_TIME_H
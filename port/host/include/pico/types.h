@@ -0,0 +1,30 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// host stand-in for the pico-sdk's `pico/types.h`
+
+#ifndef HOST_PICO_TYPES_H
+#define HOST_PICO_TYPES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef unsigned int uint;
+
+typedef uint64_t absolute_time_t; // microseconds since boot, like the sdk without PICO_OPAQUE_ABSOLUTE_TIME_T
+
+static inline uint64_t to_us_since_boot(const absolute_time_t t) {
+    return t;
+}
+
+static inline void update_us_since_boot(absolute_time_t *t, const uint64_t us_since_boot) {
+    *t = us_since_boot;
+}
+
+static inline absolute_time_t from_us_since_boot(const uint64_t us_since_boot) {
+    return us_since_boot;
+}
+
+#endif //HOST_PICO_TYPES_H
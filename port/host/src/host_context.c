@@ -0,0 +1,137 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// context switching, the host's stand-in for `context.s`
+
+#include "host_port.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "scheduler_internal.h"
+#include "spinlock_internal.h"
+
+host_thread_t host_threads[MAX_TASKS];
+
+void host_wait_for_core(host_thread_t* self) {
+    while (sem_wait(&self->go) != 0) {
+        // interrupted by a poke meant for whoever holds our old core
+    }
+
+    host_this_core = self->core;
+    host_holding = true;
+
+    if (self->fresh) {
+        siglongjmp(self->start, 1);
+    }
+}
+
+// the thread for a task that is about to be switched in
+// a task `task_add` just set up hasn't got its frame claimed yet, so its thread starts it from the top
+static host_thread_t* thread_for_task(task_t* task) {
+    host_thread_t* thread = &host_threads[task - tasks];
+
+    if (task->stack_pointer[HOST_FRAME_R12] != HOST_FRAME_CLAIMED) {
+        task->stack_pointer[HOST_FRAME_R12] = HOST_FRAME_CLAIMED;
+        thread->fresh = true;
+    }
+
+    return thread;
+}
+
+// hand this core to `to`, and park this thread until it gets a core back
+static void switch_to(host_thread_t* to) {
+    host_core_t* core = &host_cores[host_this_core];
+    host_thread_t* self = host_this_thread;
+
+    to->core = host_this_core;
+    core->holder = to;
+    host_holding = false;
+    sem_post(&to->go);
+
+    // a core thread has no task of its own to come back to
+    if (self != NULL) {
+        host_wait_for_core(self);
+    }
+}
+
+// same steps as the RP2040's PendSV, but the thread is what gets switched instead of the stack pointer
+void PendSV_Handler(void) {
+    const uint32_t saved_irq = run_queue_spin_lock_this_core();
+
+    task_t* previous = scheduler_is_started() ? get_current_task() : NULL;
+
+    get_next_task();
+
+    task_t* next = get_current_task();
+    host_thread_t* to = (next != previous) ? thread_for_task(next) : NULL;
+
+    set_scheduler_started(true);
+
+    run_queue_spin_unlock_this_core(saved_irq);
+
+    if (to != NULL) {
+        switch_to(to);
+    }
+}
+
+static void* task_thread_main(void* arg) {
+    host_thread_t* self = arg;
+    host_this_thread = self;
+
+    sigset_t interrupt;
+    sigemptyset(&interrupt);
+    sigaddset(&interrupt, HOST_INTERRUPT_SIGNAL);
+    pthread_sigmask(SIG_UNBLOCK, &interrupt, NULL);
+
+    // a task added to this slot starts here, even if the last one was parked deep inside a call
+    if (sigsetjmp(self->start, 1) == 0) {
+        host_wait_for_core(self);
+    }
+
+    self->fresh = false;
+    host_in_exception = false;
+    host_primask = 0;
+
+    task_t* task = &tasks[self - host_threads];
+    const uint32_t* frame = task->stack_pointer;
+
+    // the frame only has room for 32-bit pointers, so the ones into memory are rebuilt from the task
+    void (*task_function)(uint32_t, uint32_t*, char*) = (void (*)(uint32_t, uint32_t*, char*))(uintptr_t)frame[HOST_FRAME_PC];
+    char* args = (char*)(task->stack_base - (frame[HOST_FRAME_R3] + 3) / 4);
+
+    // whatever pended while the core was being handed over
+    host_take_interrupts();
+
+    task_function(task->id, &task->signals, args);
+    task_return();
+
+    // a finished task is switched out by `task_return`, and never back in
+    while (true) {
+        host_wfi();
+    }
+
+    return NULL;
+}
+
+void host_threads_init(void) {
+    for (uint32_t t = 0; t < MAX_TASKS; t++) {
+        host_thread_t* thread = &host_threads[t];
+        sem_init(&thread->go, 0, 0);
+
+        if (pthread_create(&thread->thread, NULL, task_thread_main, thread) != 0) {
+            fprintf(stderr, "host port: couldn't start a task thread\n");
+            abort();
+        }
+    }
+}
+
+// the scheduler starting on a core, which switches the RP2040 to its process stack
+void set_spsel(const uint32_t control) {
+    host_core_run();
+}
+
+bool is_privileged() {
+    return host_in_exception || !host_holding;
+}
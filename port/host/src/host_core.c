@@ -0,0 +1,408 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// emulated cores: interrupts, SysTick and the inter-core FIFOs
+
+#include "host_port.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "hardware/clocks.h"
+#include "pico/time.h"
+#include "scheduler_internal.h"
+
+host_core_t host_cores[CORE_COUNT];
+
+__thread volatile uint8_t host_this_core;
+__thread host_thread_t* host_this_thread;
+__thread volatile bool host_holding;
+__thread volatile bool host_in_exception;
+__thread volatile uint32_t host_primask;
+
+static pthread_t core1_thread;
+
+uint get_core_num(void) {
+    return host_this_core;
+}
+
+uint32_t save_and_disable_interrupts(void) {
+    const uint32_t status = host_primask;
+    host_primask = 1;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    return status;
+}
+
+void restore_interrupts(const uint32_t status) {
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    host_primask = status;
+
+    // anything pended while they were off is taken now
+    if (status == 0) {
+        host_take_interrupts();
+    }
+}
+
+static inline bool take_pending(host_core_t* core, const uint32_t pending) {
+    return (__atomic_fetch_and(&core->pending, ~pending, __ATOMIC_ACQ_REL) & pending) != 0;
+}
+
+// take exceptions in priority order until none are left
+// looks the core up again every time, as PendSV can come back on another one
+static void take_pending_exceptions(void) {
+    while (true) {
+        host_core_t* core = &host_cores[host_this_core];
+
+        if (!core->running) {
+            return;
+        }
+
+        if (take_pending(core, HOST_PENDING_SYSTICK)) {
+            SysTick_Handler();
+        }
+        else if (take_pending(core, HOST_PENDING_FIFO)) {
+            if (core->fifo_irq_enabled && core->fifo_handler != NULL) {
+                core->fifo_handler();
+            }
+        }
+        else if (take_pending(core, HOST_PENDING_PENDSV)) {
+            PendSV_Handler();
+        }
+        else {
+            return;
+        }
+    }
+}
+
+void host_take_interrupts(void) {
+    // something pended after the last look, but before leaving handler mode, is only seen by looking again
+    while (host_holding && !host_in_exception && host_primask == 0 &&
+           __atomic_load_n(&host_cores[host_this_core].pending, __ATOMIC_ACQUIRE) != 0) {
+        host_in_exception = true;
+        take_pending_exceptions();
+        host_in_exception = false;
+    }
+}
+
+static void interrupt_signal_handler(int signal) {
+    const int saved_errno = errno;
+    host_take_interrupts();
+    errno = saved_errno;
+}
+
+void host_pend(host_core_t* core, const uint32_t pending) {
+    __atomic_fetch_or(&core->pending, pending, __ATOMIC_ACQ_REL);
+
+    host_thread_t* holder = core->holder;
+    if (holder == NULL) {
+        return; // not started, it takes them once it is
+    }
+
+    if (holder == host_this_thread && host_holding) {
+        host_take_interrupts();
+    }
+    else {
+        pthread_kill(holder->thread, HOST_INTERRUPT_SIGNAL);
+    }
+}
+
+void host_wfi(void) {
+    sigset_t interrupt;
+    sigset_t previous;
+    sigemptyset(&interrupt);
+    sigaddset(&interrupt, HOST_INTERRUPT_SIGNAL);
+
+    // hold the signal off while looking, so a poke between looking and waiting still wakes us
+    pthread_sigmask(SIG_BLOCK, &interrupt, &previous);
+
+    if (__atomic_load_n(&host_cores[host_this_core].pending, __ATOMIC_ACQUIRE) == 0) {
+        sigset_t waiting = previous;
+        sigdelset(&waiting, HOST_INTERRUPT_SIGNAL);
+        sigsuspend(&waiting);
+    }
+
+    pthread_sigmask(SIG_SETMASK, &previous, NULL);
+    host_take_interrupts();
+}
+
+void __wfi(void) {
+    host_wfi();
+}
+
+void host_asm(const char* instruction) {
+    if (strcmp(instruction, "wfi") == 0) {
+        host_wfi();
+    }
+    else if (strcmp(instruction, "bkpt") == 0) {
+        raise(SIGTRAP); // halts like the RP2040 does without a debugger attached
+    }
+    else if (strcmp(instruction, "nop") != 0 && strcmp(instruction, "wfe") != 0 && strcmp(instruction, "sev") != 0) {
+        fprintf(stderr, "host port: can't run instruction \"%s\"\n", instruction);
+        abort();
+    }
+}
+
+/* Registers */
+
+systick_hw_t* host_systick_hw(void) {
+    return &host_cores[host_this_core].systick;
+}
+
+mpu_hw_t* host_mpu_hw(void) {
+    return &host_cores[host_this_core].mpu;
+}
+
+uintptr_t host_ppb_base(void) {
+    return (uintptr_t)&host_cores[host_this_core].icsr - M0PLUS_ICSR_OFFSET;
+}
+
+uint32_t host_pend_pendsv(void) {
+    host_pend(&host_cores[host_this_core], HOST_PENDING_PENDSV);
+    return 0;
+}
+
+/* SysTick */
+
+static void sleep_until_us(const uint64_t until_us) {
+    const uint64_t now_us = time_us_64();
+    if (until_us <= now_us) {
+        return;
+    }
+
+    const uint64_t delay_us = until_us - now_us;
+    const struct timespec delay = {
+        .tv_sec = (time_t)(delay_us / 1000000),
+        .tv_nsec = (long)(delay_us % 1000000) * 1000,
+    };
+
+    nanosleep(&delay, NULL); // if a signal cuts it short, `host_core_run` works out how long is left
+}
+
+// how long a SysTick count from `rvr` takes at the emulated clock speed
+static uint64_t systick_period_us(const uint32_t rvr) {
+    const uint64_t period_us = (((uint64_t)rvr + 1) * 1000000) / clock_get_hz(clk_sys);
+    return (period_us == 0) ? 1 : period_us;
+}
+
+void host_core_run(void) {
+    host_core_t* core = &host_cores[host_this_core];
+    core->running = true;
+
+    // the first context switch, which the RP2040 takes as soon as the core switches to its process stack
+    host_in_exception = true;
+    PendSV_Handler();
+    host_in_exception = false;
+
+    systick_hw_t* systick = &core->systick;
+    uint64_t count_start_us = time_us_64();
+
+    while (true) {
+        const uint64_t now_us = time_us_64();
+
+        // the kernel writes 0 to the current value to restart the count
+        if (systick->cvr == 0) {
+            systick->cvr = systick->rvr;
+            count_start_us = now_us;
+        }
+
+        const bool enabled = (systick->csr & M0PLUS_SYST_CSR_ENABLE_BITS) != 0;
+        const uint64_t period_us = systick_period_us(systick->rvr);
+        const uint64_t due_us = count_start_us + period_us;
+
+        if (enabled && now_us >= due_us) {
+            // keep the ticks evenly spaced, unless we fell a whole tick behind
+            count_start_us = (now_us - due_us < period_us) ? due_us : now_us;
+
+            if (systick->csr & M0PLUS_SYST_CSR_TICKINT_BITS) {
+                host_pend(core, HOST_PENDING_SYSTICK);
+            }
+            continue;
+        }
+
+        // never sleep more than a normal tick, so a SysTick the kernel reprograms is noticed in time
+        const uint64_t longest_sleep_us = now_us + LOOP_TIME_US;
+        sleep_until_us((enabled && due_us < longest_sleep_us) ? due_us : longest_sleep_us);
+    }
+}
+
+/* Multicore */
+
+static void* core1_main(void* entry) {
+    host_this_core = 1;
+    ((void (*)(void))entry)();
+    return NULL;
+}
+
+void multicore_reset_core1(void) {
+    // core 1 is only ever launched once
+}
+
+void multicore_launch_core1(void (*entry)(void)) {
+    if (pthread_create(&core1_thread, NULL, core1_main, (void*)entry) != 0) {
+        fprintf(stderr, "host port: couldn't start core 1\n");
+        abort();
+    }
+}
+
+static inline host_core_t* other_core(void) {
+    return &host_cores[(host_this_core + 1) % CORE_COUNT];
+}
+
+// push into the other core's FIFO, if it has room
+static bool fifo_try_push(const uint32_t data) {
+    host_core_t* core = other_core();
+
+    const uint32_t saved_irq = spin_lock_blocking(&core->fifo_lock);
+    const bool room = core->fifo_count < SIO_FIFO_DEPTH;
+    if (room) {
+        core->fifo[(core->fifo_head + core->fifo_count) % SIO_FIFO_DEPTH] = data;
+        core->fifo_count++;
+    }
+    spin_unlock_unsafe(&core->fifo_lock);
+
+    if (room && core->fifo_irq_enabled) {
+        host_pend(core, HOST_PENDING_FIFO);
+    }
+
+    restore_interrupts(saved_irq);
+    return room;
+}
+
+// pop from this core's FIFO, if it has anything
+static bool fifo_try_pop(uint32_t* data) {
+    host_core_t* core = &host_cores[host_this_core];
+
+    const uint32_t saved_irq = spin_lock_blocking(&core->fifo_lock);
+    const bool valid = core->fifo_count > 0;
+    if (valid) {
+        *data = core->fifo[core->fifo_head];
+        core->fifo_head = (core->fifo_head + 1) % SIO_FIFO_DEPTH;
+        core->fifo_count--;
+    }
+    spin_unlock(&core->fifo_lock, saved_irq);
+
+    return valid;
+}
+
+bool multicore_fifo_rvalid(void) {
+    return host_cores[host_this_core].fifo_count > 0;
+}
+
+bool multicore_fifo_wready(void) {
+    return other_core()->fifo_count < SIO_FIFO_DEPTH;
+}
+
+void multicore_fifo_push_blocking(const uint32_t data) {
+    while (!fifo_try_push(data)) {
+        __wfe();
+    }
+}
+
+bool multicore_fifo_push_timeout_us(const uint32_t data, const uint64_t timeout_us) {
+    const absolute_time_t timeout = make_timeout_time_us(timeout_us);
+
+    do {
+        if (fifo_try_push(data)) {
+            return true;
+        }
+        __wfe();
+    } while (!time_reached(timeout));
+
+    return false;
+}
+
+uint32_t multicore_fifo_pop_blocking(void) {
+    uint32_t data;
+    while (!fifo_try_pop(&data)) {
+        __wfe();
+    }
+    return data;
+}
+
+bool multicore_fifo_pop_timeout_us(const uint64_t timeout_us, uint32_t* out) {
+    const absolute_time_t timeout = make_timeout_time_us(timeout_us);
+
+    do {
+        if (fifo_try_pop(out)) {
+            return true;
+        }
+        __wfe();
+    } while (!time_reached(timeout));
+
+    return false;
+}
+
+void multicore_fifo_drain(void) {
+    uint32_t data;
+    while (fifo_try_pop(&data)) {
+    }
+}
+
+void multicore_fifo_clear_irq(void) {
+    // no overflow or underflow flags to clear, the interrupt stays pending while there is data
+    host_core_t* core = &host_cores[host_this_core];
+    if (core->fifo_count > 0 && core->fifo_irq_enabled) {
+        __atomic_fetch_or(&core->pending, HOST_PENDING_FIFO, __ATOMIC_ACQ_REL);
+    }
+}
+
+/* Interrupt Controller */
+
+static host_core_t* core_of_irq(const uint num) {
+    if (num < SIO_IRQ_PROC0 || num >= SIO_IRQ_PROC0 + CORE_COUNT) {
+        fprintf(stderr, "host port: irq %u doesn't exist on the host\n", num);
+        abort();
+    }
+
+    return &host_cores[num - SIO_IRQ_PROC0];
+}
+
+void irq_set_exclusive_handler(const uint num, const irq_handler_t handler) {
+    core_of_irq(num)->fifo_handler = handler;
+}
+
+void irq_remove_handler(const uint num, const irq_handler_t handler) {
+    host_core_t* core = core_of_irq(num);
+    if (core->fifo_handler == handler) {
+        core->fifo_handler = NULL;
+    }
+}
+
+void irq_set_enabled(const uint num, const bool enabled) {
+    host_core_t* core = core_of_irq(num);
+    core->fifo_irq_enabled = enabled;
+
+    if (enabled && core->fifo_count > 0) {
+        host_pend(core, HOST_PENDING_FIFO);
+    }
+}
+
+bool irq_is_enabled(const uint num) {
+    return core_of_irq(num)->fifo_irq_enabled;
+}
+
+/* Start Up */
+
+__attribute__((constructor))
+static void host_port_init(void) {
+    // task functions reach the port through the 32-bit PC slot of their starting frame
+    if ((uintptr_t)&host_port_init > UINT32_MAX) {
+        fprintf(stderr, "host port: code has to be below 4 GiB, link with -no-pie\n");
+        abort();
+    }
+
+    (void)time_us_64(); // starts the clock
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = interrupt_signal_handler;
+    action.sa_flags = SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    sigaction(HOST_INTERRUPT_SIGNAL, &action, NULL);
+
+    host_threads_init();
+}
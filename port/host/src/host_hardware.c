@@ -0,0 +1,97 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// the timer, clocks and the rest of the peripherals the kernel touches
+
+#include <stdio.h>
+#include <time.h>
+
+#include "host_port.h"
+#include "hardware/clocks.h"
+#include "hardware/pwm.h"
+#include "hardware/timer.h"
+#include "hardware/uart.h"
+#include "pico/stdio.h"
+#include "pico/time.h"
+
+const absolute_time_t at_the_end_of_time = INT64_MAX;
+const absolute_time_t nil_time = 0;
+
+static volatile uint32_t clock_khz = HOST_DEFAULT_CLOCK_KHZ;
+
+static uint64_t monotonic_us(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000 + (uint64_t)now.tv_nsec / 1000;
+}
+
+uint64_t time_us_64(void) {
+    static uint64_t boot_us = 0;
+
+    if (boot_us == 0) {
+        boot_us = monotonic_us(); // the port's constructor gets here first
+    }
+
+    return monotonic_us() - boot_us;
+}
+
+void busy_wait_us(const uint64_t delay_us) {
+    const uint64_t until_us = time_us_64() + delay_us;
+
+    while (time_us_64() < until_us) {
+        __wfe();
+    }
+}
+
+void sleep_us(const uint64_t us) {
+    busy_wait_us(us);
+}
+
+uint32_t clock_get_hz(const enum clock_index clk_index) {
+    return clock_khz * 1000;
+}
+
+bool set_sys_clock_khz(const uint32_t freq_khz, const bool required) {
+    clock_khz = freq_khz;
+    return true;
+}
+
+// a pwm slice counts from when it was started, at the system clock divided by its divider
+static struct {
+    pwm_config config;
+    uint64_t start_ns;
+} pwm_slices[NUM_PWM_SLICES];
+
+static uint64_t monotonic_ns(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + (uint64_t)now.tv_nsec;
+}
+
+void pwm_init(const uint slice_num, pwm_config* c, const bool start) {
+    pwm_slices[slice_num].config = *c;
+    pwm_slices[slice_num].start_ns = start ? monotonic_ns() : 0;
+}
+
+uint16_t pwm_get_counter(const uint slice_num) {
+    if (pwm_slices[slice_num].start_ns == 0) {
+        return 0;
+    }
+
+    const uint64_t elapsed_ns = monotonic_ns() - pwm_slices[slice_num].start_ns;
+    const uint64_t cycles = elapsed_ns * clock_khz / 1000000;
+    const uint64_t counts = cycles * 16 / pwm_slices[slice_num].config.div;
+
+    return (uint16_t)(counts % (pwm_slices[slice_num].config.top + 1));
+}
+
+uart_hw_t* uart_get_hw(uart_inst_t* uart) {
+    static uart_hw_t uart_hw[2] = {{1, 0}, {1, 0}};
+    return &uart_hw[(uintptr_t)uart];
+}
+
+bool stdio_init_all(void) {
+    setvbuf(stdout, NULL, _IOLBF, 0);
+    return true;
+}
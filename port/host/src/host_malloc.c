@@ -0,0 +1,42 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// the heap, with interrupts off so an exception that allocates can't land inside an allocation on the same thread
+// (linked in with `--wrap`, like the pico-sdk's `pico_malloc`)
+
+#include <stddef.h>
+
+#include "hardware/sync.h"
+
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* memory, size_t size);
+void __real_free(void* memory);
+
+void* __wrap_malloc(const size_t size) {
+    const uint32_t saved_irq = save_and_disable_interrupts();
+    void* memory = __real_malloc(size);
+    restore_interrupts(saved_irq);
+    return memory;
+}
+
+void* __wrap_calloc(const size_t count, const size_t size) {
+    const uint32_t saved_irq = save_and_disable_interrupts();
+    void* memory = __real_calloc(count, size);
+    restore_interrupts(saved_irq);
+    return memory;
+}
+
+void* __wrap_realloc(void* memory, const size_t size) {
+    const uint32_t saved_irq = save_and_disable_interrupts();
+    void* moved = __real_realloc(memory, size);
+    restore_interrupts(saved_irq);
+    return moved;
+}
+
+void __wrap_free(void* memory) {
+    const uint32_t saved_irq = save_and_disable_interrupts();
+    __real_free(memory);
+    restore_interrupts(saved_irq);
+}
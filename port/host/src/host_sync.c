@@ -0,0 +1,60 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// spinlocks, words of memory standing in for the SIO's lock registers
+
+#include "hardware/sync.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+static spin_lock_t spin_locks[NUM_SPIN_LOCKS];
+static uint32_t claimed_spin_locks;
+
+spin_lock_t* spin_lock_instance(const uint lock_num) {
+    return &spin_locks[lock_num];
+}
+
+void spin_lock_claim(const uint lock_num) {
+    const uint32_t bit = 1u << lock_num;
+
+    if (__atomic_fetch_or(&claimed_spin_locks, bit, __ATOMIC_ACQ_REL) & bit) {
+        fprintf(stderr, "host port: spinlock %u is already claimed\n", lock_num);
+        abort();
+    }
+}
+
+void spin_lock_claim_mask(const uint32_t lock_num_mask) {
+    for (uint lock_num = 0; lock_num < NUM_SPIN_LOCKS; lock_num++) {
+        if (lock_num_mask & (1u << lock_num)) {
+            spin_lock_claim(lock_num);
+        }
+    }
+}
+
+void spin_lock_unclaim(const uint lock_num) {
+    spin_unlock_unsafe(spin_lock_instance(lock_num));
+    __atomic_fetch_and(&claimed_spin_locks, ~(1u << lock_num), __ATOMIC_ACQ_REL);
+}
+
+int spin_lock_claim_unused(const bool required) {
+    for (uint lock_num = PICO_SPINLOCK_ID_CLAIM_FREE_FIRST; lock_num <= PICO_SPINLOCK_ID_CLAIM_FREE_LAST; lock_num++) {
+        const uint32_t bit = 1u << lock_num;
+
+        if (!(__atomic_fetch_or(&claimed_spin_locks, bit, __ATOMIC_ACQ_REL) & bit)) {
+            return (int)lock_num;
+        }
+    }
+
+    if (required) {
+        fprintf(stderr, "host port: no spinlocks left to claim\n");
+        abort();
+    }
+
+    return -1;
+}
+
+bool spin_lock_is_claimed(const uint lock_num) {
+    return (__atomic_load_n(&claimed_spin_locks, __ATOMIC_ACQUIRE) & (1u << lock_num)) != 0;
+}
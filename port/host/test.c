@@ -0,0 +1,426 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// kernel tests that check their own results, so they can run off-target under ctest
+// (the same file is built against each host kernel configuration, see CMakeLists.txt)
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "pico/stdlib.h"
+#include "hardware/sync.h"
+#include "hardware/structs/mpu.h"
+#include "kernel_config.h"
+#include "channel.h"
+#include "channel_internal.h"
+#include "counting_semaphore.h"
+#include "event_group.h"
+#include "mutex.h"
+#include "scheduler.h"
+#include "scheduler_internal.h"
+#include "stack_guard.h"
+#include "stack_pool.h"
+#include "sync_tests.h"
+#include "trace.h"
+
+#define TEST_PID 10             // clear of the ids the idle tasks take
+#define TEST_HELPER_PID 11      // the tasks a test starts take ids from here
+#define TEST_PRIORITY 5
+#define TEST_TIMEOUT_MS 2000    // the longest a test waits for the kernel to get something done
+
+#define TEST_ARGS "stack test"
+#define TEST_MESSAGE "borrowed"
+#define TEST_HOLD_MS 50         // how long a helper holds onto part of a channel before giving it back
+
+static uint32_t failures;
+
+// print how a test went, the same way test/main.c does, and count it if it failed
+static void test_report(const bool passed, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    if (passed) {
+        printf(" " "\e[0;32m" "SUCCESS" "\e[0m" "\n");
+    } else {
+        printf(" " "\e[0;31m" "FAIL" "\e[0m" "\n");
+        failures++;
+    }
+}
+
+static task_t* find_task(const uint32_t pid) {
+    for (uint32_t t = 0; t < MAX_TASKS; t++) {
+        if (tasks[t].id == pid && tasks[t].state != TASK_FREE) {
+            return &tasks[t];
+        }
+    }
+
+    return NULL;
+}
+
+/* Task Ids */
+void reserved_pid_task(uint32_t pid, uint32_t* signals, char* args) {
+}
+
+static void test_reserved_pids() {
+    const uint32_t unused_pid = KERNEL_PID_BASE + 0x80;   // reserved, but none of the kernel's tasks has it
+    const kelp_error_t error = task_add(reserved_pid_task, unused_pid, TEST_PRIORITY);
+    test_report(error == KELP_ID_TAKEN && !task_exists(unused_pid) && task_exists(KERNEL_WORKER_PID),
+                "The kernel's task ids are refused to applications, and its own tasks got them");
+}
+
+/* Stacks */
+
+#if DYNAMIC_STACK
+// the arguments sit at the very top of the stack, so they show whether it was moved whole
+static bool args_intact(const task_t* task) {
+    const uint32_t args_words = (sizeof(TEST_ARGS) + 3) / 4;
+    return strcmp((const char*)(task->stack_base - args_words), TEST_ARGS) == 0;
+}
+
+static void test_stack_resizing() {
+    printf("Testing Stack Growth\n");
+    task_t* self = get_current_task();
+    const uint32_t start_size = self->stack_size;
+    const uint32_t buffer_bytes = start_size * 2 * sizeof(uint32_t);
+
+    kelp_error_t error = task_stack_fit_buffer(64, buffer_bytes, false);
+    const uint32_t grown_size = self->stack_size;
+
+    test_report(error == KELP_OK && grown_size >= start_size * 2 && args_intact(self),
+                "Grew from %u to %u words (%d)", start_size, grown_size, error);
+
+    printf("Testing Stack Shrinking\n");
+    error = task_stack_fit_buffer(0, 0, true);
+
+    test_report(error == KELP_OK && self->stack_size == stack_pool_block_words(MIN_STACK_SIZE) && args_intact(self),
+                "Shrank from %u to %u words (%d)", grown_size, self->stack_size, error);
+}
+#endif
+
+// host tasks run on their threads' stacks, so this one pretends to have gone deep into its own
+void deep_stack_task(uint32_t pid, uint32_t* signals, char* args) {
+    task_t* self = get_current_task();
+    self->stack[STACK_OVERFLOW_THRESHOLD / 2] = 0;
+
+    task_wait_signals(TASK_SIGUSR2, TASK_WAIT_FOREVER);
+}
+
+// a blocked task that is nearly out of stack is given more, or suspended if its stack can't grow
+static bool scan_caught(const task_t* task, const uint32_t start_size) {
+#if DYNAMIC_STACK
+    return task->stack_size > start_size && task->state == TASK_BLOCKED;
+#else
+    return task->state == TASK_SUSPENDED;
+#endif
+}
+
+static void test_stack_scan() {
+    printf("Testing Stack Usage Scan\n");
+    const uint32_t deep_pid = TEST_HELPER_PID;
+
+    // above us on our core, so it has dirtied its stack before the scan can get to it
+    task_add_affinity(deep_stack_task, deep_pid, TEST_PRIORITY + 1, TASK_CORE(0));
+    task_t* deep = find_task(deep_pid);
+    const uint32_t start_size = deep->stack_size;
+
+    uint32_t waited_ms = 0;
+    while (!scan_caught(deep, start_size) && waited_ms < TEST_TIMEOUT_MS) {
+        task_sleep_ms(10);
+        waited_ms += 10;
+    }
+
+    test_report(scan_caught(deep, start_size), "Scan found it after %ums, %u to %u words", waited_ms, start_size, deep->stack_size);
+    sync_test_kill(deep_pid);
+}
+
+#if STACK_GUARD_MPU
+void hard_fault_handler_c(uint32_t* fault_stack);
+
+static bool guard_covers(const task_t* task) {
+    return (mpu_hw->rbar & M0PLUS_MPU_RBAR_ADDR_BITS) == (uint32_t)(uintptr_t)task->stack &&
+           (mpu_hw->rasr & M0PLUS_MPU_RASR_ENABLE_BITS);
+}
+
+static void test_stack_guard() {
+    printf("Testing Stack Guard\n");
+    task_t* self = get_current_task();
+    const bool guarded = guard_covers(self);
+    const uint32_t start_size = self->stack_size;
+
+    // stand in for the HardFault the guard raises, from a push just above the guard,
+    // with the frame pushed into the room left between the guard and the stack pointer
+    hard_fault_handler_c(self->stack + STACK_GUARD_WORDS + 1);
+
+    test_report(guarded && self->stack_size > start_size && guard_covers(self),
+                "Guard hit grew the stack from %u to %u words", start_size, self->stack_size);
+}
+#endif
+
+/* Channels */
+
+static volatile bool borrow_held;
+static volatile bool borrow_intact;     // whether the borrowed message was still there when it was given back
+static volatile kelp_error_t release_error;
+
+// wait until the task that started us has connected a channel to us
+static uint16_t test_wait_for_channel() {
+    uint16_t channel_id = 0;
+    uint16_t connected = 0;
+
+    while (connected == 0) {
+        get_connected_channels(&channel_id, &connected, 1);
+        task_sleep_ms(1);
+    }
+
+    return channel_id;
+}
+
+// borrows the first message it gets, and holds onto it for a while before giving it back
+void borrower_task(uint32_t pid, uint32_t* signals, char* args) {
+    const uint16_t channel_id = test_wait_for_channel();
+
+    const uint8_t* message;
+    uint16_t size;
+    if (com_channel_borrow_blocking(channel_id, &message, &size) == KELP_OK) {
+        borrow_held = true;
+        task_sleep_ms(TEST_HOLD_MS);
+
+        borrow_intact = size == sizeof(TEST_MESSAGE) && memcmp(message, TEST_MESSAGE, size) == 0;
+        release_error = com_channel_release(channel_id);
+    }
+
+    task_wait_signals(TASK_SIGUSR2, TASK_WAIT_FOREVER);
+}
+
+// the channel can't be wiped under the partner, it has to wait until the message is given back
+static void test_free_while_borrowed() {
+    printf("Testing Freeing a Channel with a Message Borrowed\n");
+    borrow_held = false;
+    borrow_intact = false;
+    release_error = KELP_OK;
+
+    task_add_affinity(borrower_task, TEST_HELPER_PID, TEST_PRIORITY, TASK_CORE(1));
+
+    uint16_t channel_id;
+    kelp_error_t error = com_channel_request_blocking(TEST_HELPER_PID, false, &channel_id);
+    if (error == KELP_OK) {
+        error = com_channel_write(channel_id, (const uint8_t*)TEST_MESSAGE, sizeof(TEST_MESSAGE));
+    }
+
+    for (uint32_t waited_ms = 0; !borrow_held && waited_ms < TEST_TIMEOUT_MS; waited_ms += 10) {
+        task_sleep_ms(10);
+    }
+
+    const uint32_t start_us = time_us_32();
+    if (error == KELP_OK && borrow_held) {
+        error = com_channel_free(channel_id);
+    }
+    const uint32_t took_ms = (time_us_32() - start_us) / 1000;
+
+    // the partner finds out the channel is going when it gives the message back
+    test_report(error == KELP_OK && borrow_intact && release_error == KELP_NOT_CONNECTED &&
+                com_channels[channel_id].state == CHANNEL_FREE,
+                "Freed after %ums, message %s until given back (%d, release %d)", took_ms,
+                borrow_intact ? "intact" : "wiped", error, release_error);
+    sync_test_kill(TEST_HELPER_PID);
+}
+
+// connects a channel to the task that started it, and then never frees it
+void channel_owner_task(uint32_t pid, uint32_t* signals, char* args) {
+    uint16_t channel_id;
+    com_channel_request_blocking(TEST_PID, false, &channel_id);
+
+    task_wait_signals(TASK_SIGUSR2, TASK_WAIT_FOREVER);
+}
+
+// a channel whose owner is gone is freed by the kernel, which doesn't own it either
+static void test_free_after_owner_died() {
+    printf("Testing Freeing a Channel After its Owner Died\n");
+    task_add_affinity(channel_owner_task, TEST_HELPER_PID, TEST_PRIORITY, TASK_CORE(1));
+
+    const uint16_t channel_id = test_wait_for_channel();
+    const bool killed = sync_test_kill(TEST_HELPER_PID);
+
+    uint32_t waited_ms = 0;
+    while (com_channels[channel_id].state != CHANNEL_FREE && waited_ms < TEST_TIMEOUT_MS) {
+        task_sleep_ms(10);
+        waited_ms += 10;
+    }
+
+    test_report(killed && com_channels[channel_id].state == CHANNEL_FREE && !is_connected_to_channel(channel_id),
+                "Channel %u freed %ums after its owner died", channel_id, waited_ms);
+}
+
+/* Killing Blocked Tasks */
+
+typedef enum {
+    KILL_SEMAPHORE,
+    KILL_MUTEX,
+    KILL_EVENT_GROUP,
+    KILL_CHANNEL,
+    KILL_SIGNALS,
+    KILL_CASES,
+} kill_case_t;
+
+static const char* kill_case_names[KILL_CASES] = {
+    "kelp_semaphore_take",
+    "kelp_mutex_lock",
+    "kelp_event_group_wait",
+    "com_channel_borrow_blocking",
+    "task_wait_signals",
+};
+
+static kelp_mutex_t kill_held_mutex = KELP_MUTEX_INIT;     // the victim holds it, so it can't die until it lets go
+static kelp_mutex_t kill_taken_mutex = KELP_MUTEX_INIT;    // the test holds it, for the victim to block on
+static kelp_semaphore_t kill_semaphore = KELP_SEMAPHORE_INIT(0, 1);
+static kelp_event_group_t kill_events = KELP_EVENT_GROUP_INIT;
+static volatile kill_case_t kill_case;
+static volatile kelp_error_t kill_results[2];
+
+// block forever on what this case is about
+static kelp_error_t kill_victim_wait(const uint16_t channel_id) {
+    const uint8_t* message;
+    uint16_t size;
+
+    switch (kill_case) {
+        case KILL_SEMAPHORE:
+            return kelp_semaphore_take(&kill_semaphore);
+        case KILL_MUTEX:
+            return kelp_mutex_lock(&kill_taken_mutex);
+        case KILL_EVENT_GROUP:
+            return kelp_event_group_wait(&kill_events, 1, KELP_EVENT_WAIT_ANY, NULL);
+        case KILL_CHANNEL:
+            return com_channel_borrow_blocking(channel_id, &message, &size);
+        default:
+            // no signals is all it can give back
+            return task_wait_signals(TASK_SIGUSR1, TASK_WAIT_FOREVER) == 0 ? KELP_KILLED : KELP_OK;
+    }
+}
+
+// holds a mutex and blocks, then tries to block again once killed, and only lets go of the mutex after that
+void kill_victim_task(uint32_t pid, uint32_t* signals, char* args) {
+    const uint16_t channel_id = kill_case == KILL_CHANNEL ? test_wait_for_channel() : 0;
+
+    kelp_mutex_lock(&kill_held_mutex);
+    kill_results[0] = kill_victim_wait(channel_id);
+    kill_results[1] = kill_victim_wait(channel_id);
+    kelp_mutex_unlock(&kill_held_mutex);
+}
+
+// a killed task that can't die yet must not be left blocked, and every wait it starts has to end at once
+static void test_kill_blocked() {
+    printf("Testing Killing Tasks Blocked on Each Primitive\n");
+    kelp_mutex_lock(&kill_taken_mutex);
+
+    for (kill_case_t c = 0; c < KILL_CASES; c++) {
+        kill_case = c;
+        kill_results[0] = KELP_OK;
+        kill_results[1] = KELP_OK;
+
+        task_add_affinity(kill_victim_task, TEST_HELPER_PID, TEST_PRIORITY, TASK_CORE(1));
+        const task_t* victim = find_task(TEST_HELPER_PID);
+
+        uint16_t channel_id = 0;
+        const kelp_error_t error = c == KILL_CHANNEL ? com_channel_request_blocking(TEST_HELPER_PID, false, &channel_id)
+                                                     : KELP_OK;
+
+        for (uint32_t waited_ms = 0; victim->state != TASK_BLOCKED && waited_ms < TEST_TIMEOUT_MS; waited_ms++) {
+            task_sleep_ms(1);
+        }
+
+        const bool blocked = victim->state == TASK_BLOCKED;
+        const bool killed = sync_test_kill(TEST_HELPER_PID);
+
+        test_report(error == KELP_OK && blocked && killed && kill_results[0] == KELP_KILLED &&
+                    kill_results[1] == KELP_KILLED, "Killed while blocked in %s (%d, then %d)",
+                    kill_case_names[c], kill_results[0], kill_results[1]);
+
+        if (c == KILL_CHANNEL && error == KELP_OK) {
+            com_channel_free(channel_id);
+        }
+    }
+
+    kelp_mutex_unlock(&kill_taken_mutex);
+}
+
+#if TRACE
+/* Tracing */
+
+static trace_event_t trace_events[TRACE_BUFFER_SIZE];
+
+// the state events core 0 recorded for `pid` since the last read, newest last
+static uint32_t test_read_states(const uint32_t pid, trace_event_t* states, const uint32_t max) {
+    const uint32_t count = trace_read(0, trace_events, TRACE_BUFFER_SIZE);
+    uint32_t found = 0;
+
+    for (uint32_t e = 0; e < count && found < max; e++) {
+        if (trace_events[e].type == TRACE_STATE && trace_events[e].a == pid) {
+            states[found++] = trace_events[e];
+        }
+    }
+
+    return found;
+}
+
+void trace_waiter_task(uint32_t pid, uint32_t* signals, char* args) {
+    task_wait_signals(TASK_SIGUSR1, TASK_WAIT_FOREVER);
+}
+
+// a stop that is pending as a blocked task is woken stops it there, so the trace shows it stopping and nothing else
+static void test_trace_stop_on_wake() {
+    printf("Testing Tracing a Stop Pending on Wakeup\n");
+    task_add_affinity(trace_waiter_task, TEST_HELPER_PID, TEST_PRIORITY, TASK_CORE(0));
+    task_sleep_ms(10); // for it to block
+
+    trace_event_t states[4];
+    test_read_states(TEST_HELPER_PID, states, 4);
+
+    task_signal(TEST_HELPER_PID, TASK_SIGSTOP);
+    task_signal(TEST_HELPER_PID, TASK_SIGUSR1);
+    const uint32_t count = test_read_states(TEST_HELPER_PID, states, 4);
+
+    test_report(count == 1 && states[0].detail == TASK_STOPPED && states[0].value == TASK_BLOCKED,
+                "%u state events, the first to %u from %u", count,
+                count > 0 ? states[0].detail : 0, count > 0 ? states[0].value : 0);
+    sync_test_kill(TEST_HELPER_PID);
+}
+#endif
+
+void test_task(uint32_t pid, uint32_t* signals, char* args) {
+    printf("\nStarting Host Tests\n");
+
+    test_reserved_pids();
+
+#if DYNAMIC_STACK
+    test_stack_resizing();
+#endif
+    test_stack_scan();
+#if STACK_GUARD_MPU
+    test_stack_guard();
+#endif
+    test_free_while_borrowed();
+    test_free_after_owner_died();
+    sync_tests_run(TEST_HELPER_PID, test_report);
+    test_kill_blocked();
+#if TRACE
+    test_trace_stop_on_wake();
+#endif
+
+    printf("\n%u failed\n", failures);
+    exit(failures == 0 ? 0 : 1);
+}
+
+int main() {
+    stdio_init_all();
+
+    task_add_args_affinity(test_task, TEST_PID, TEST_ARGS, TEST_PRIORITY, TASK_CORE(0));
+
+    kernel_start();
+
+    return 1; // the kernel never gives the core back
+}
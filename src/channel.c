@@ -8,43 +8,288 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "hardware/sync.h"
+#include "pico/time.h"
 #include "scheduler.h"
 #include "scheduler_internal.h"
 #include "spinlock_internal.h"
+#include "trace_internal.h"
 
 com_channel_t com_channels[NUM_CHANNELS];
 
+/*
+ * Each fifo has exactly one writer and one reader, so the data path is a lock-free
+ * single-producer single-consumer ring: only the writer moves `tail` and only the reader moves `head`.
+ * The channel spinlock is only taken to connect, free, and to block or wake a task.
+ *
+ * So freeing can't take the buffers out from under either end: while an end uses a fifo it raises its own flag
+ * (`writing` or `reading`), and then checks that the channel is still connected.
+ * An acquired slot or a borrowed message is part of the buffer too, so the flag stays up until it is given back.
+ * `com_channel_free` marks the channel closing, and only wipes it once it sees both ends' flags down.
+ * With a barrier between the flag and the check, either the end sees the channel closing or the freer sees the flag.
+ */
+
+// drop everything in the fifo, the channel spinlock must be held
+static void fifo_reset(channel_fifo_t* fifo) {
+    fifo->head = fifo->tail;
+    fifo->loaned = false;
+    fifo->borrowed = false;
+}
+
+static inline uint32_t fifo_used(const channel_fifo_t* fifo) {
+    return fifo->tail - fifo->head;
+}
+
+static inline bool fifo_has_message(const channel_fifo_t* fifo) {
+    return fifo->tail != fifo->head;
+}
+
+// how much of the ring a message of `size` bytes takes up, header included
+static inline uint32_t fifo_span(const uint16_t size) {
+    return (CHANNEL_HEADER_SIZE + size + 1) & ~1u; // keep messages 2-byte aligned, so a header never wraps
+}
+
+// writer only: where a message of `size` bytes would start, skipping to the front of the buffer if it wouldn't fit before the end
+// returns false if there isn't room for it right now
+static bool fifo_reserve(const channel_fifo_t* fifo, const uint16_t size, uint32_t* position) {
+    const uint32_t tail = fifo->tail;
+    const uint32_t left_before_end = CHANNEL_BUFFER_SIZE - (tail & CHANNEL_BUFFER_MASK);
+    const uint32_t padding = (left_before_end < fifo_span(size)) ? left_before_end : 0;
+
+    if (padding + fifo_span(size) > CHANNEL_BUFFER_SIZE - fifo_used(fifo)) {
+        return false;
+    }
+
+    *position = tail + padding;
+    return true;
+}
+
+// whether a message of `size` bytes fits in the fifo right now
+static inline bool fifo_fits(const channel_fifo_t* fifo, const uint16_t size) {
+    uint32_t position;
+    return fifo_reserve(fifo, size, &position);
+}
+
+static inline uint8_t* fifo_at(const channel_fifo_t* fifo, const uint32_t position) {
+    return &fifo->bytes[position & CHANNEL_BUFFER_MASK];
+}
+
+static inline void fifo_write_header(const channel_fifo_t* fifo, const uint32_t position, const uint16_t value) {
+    uint8_t* header = fifo_at(fifo, position);
+    header[0] = value >> 8;
+    header[1] = value;
+}
+
+static inline uint16_t fifo_read_header(const channel_fifo_t* fifo, const uint32_t position) {
+    const uint8_t* header = fifo_at(fifo, position);
+    return header[0] << 8 | header[1];
+}
+
+// writer only: publish a message of `size` bytes already written at `position` (from `fifo_reserve`)
+static void fifo_publish(channel_fifo_t* fifo, const uint32_t position, const uint16_t size) {
+    const uint32_t tail = fifo->tail;
+
+    // mark the skipped end of the buffer, so the reader jumps over it too
+    if (position != tail) {
+        fifo_write_header(fifo, tail, CHANNEL_PADDING);
+    }
+
+    fifo_write_header(fifo, position, size);
+
+    __dmb(); // the message has to be in memory before the reader can see it
+    fifo->tail = position + fifo_span(size);
+}
+
+// reader only: length of the oldest message, `fifo_has_message` has to have been true
+// leaves `head` pointing at it
+static uint16_t fifo_front_size(channel_fifo_t* fifo) {
+    __dmb(); // don't read the message from before the writer published it
+
+    if (fifo_read_header(fifo, fifo->head) == CHANNEL_PADDING) {
+        // the writer skipped to the front of the buffer, and there's always a message after padding
+        fifo->head = fifo->head + (CHANNEL_BUFFER_SIZE - (fifo->head & CHANNEL_BUFFER_MASK));
+    }
+
+    return fifo_read_header(fifo, fifo->head);
+}
+
+// reader only: the bytes of the oldest message, after `fifo_front_size`
+static inline uint8_t* fifo_front(const channel_fifo_t* fifo) {
+    return fifo_at(fifo, fifo->head + CHANNEL_HEADER_SIZE);
+}
+
+// reader only: drop the oldest message, `fifo_has_message` has to have been true
+static void fifo_pop(channel_fifo_t* fifo) {
+    const uint32_t taken = fifo_span(fifo_front_size(fifo));
+
+    __dmb(); // we have to be done reading before the writer can reuse the space
+    fifo->head = fifo->head + taken;
+}
+
+// the fifo the current task writes to
+static channel_fifo_t* fifo_outgoing(const uint16_t channel_id) {
+    com_channel_t* channel = &com_channels[channel_id];
+    return is_owner_of_channel_no_lock(channel_id) ? &channel->fifo_tx : &channel->fifo_rx;
+}
+
+// the fifo the current task reads from
+static channel_fifo_t* fifo_incoming(const uint16_t channel_id) {
+    com_channel_t* channel = &com_channels[channel_id];
+    return is_owner_of_channel_no_lock(channel_id) ? &channel->fifo_rx : &channel->fifo_tx;
+}
+
+// start using the fifo the current task writes to, raising its `writing` flag until `fifo_stop_writing`
+static kelp_error_t fifo_start_writing(const uint16_t channel_id, channel_fifo_t** fifo) {
+    if (!is_connected_to_channel_no_lock(channel_id)) {
+        return KELP_NOT_CONNECTED;
+    }
+
+    *fifo = fifo_outgoing(channel_id);
+    (*fifo)->writing = true;
+
+    __dmb(); // the flag has to be up before we look, see above
+    if (com_channels[channel_id].state != CHANNEL_CONNECTED) {
+        // the channel is going, and any slot we had acquired with it
+        (*fifo)->loaned = false;
+        (*fifo)->writing = false;
+        return KELP_NOT_CONNECTED;
+    }
+
+    return KELP_OK;
+}
+
+// the flag stays up while a slot is acquired
+static void fifo_stop_writing(channel_fifo_t* fifo) {
+    __dmb(); // we have to be done with the buffer before the freer can see the flag down
+    fifo->writing = fifo->loaned;
+}
+
+// start using the fifo the current task reads from, raising its `reading` flag until `fifo_stop_reading`
+static kelp_error_t fifo_start_reading(const uint16_t channel_id, channel_fifo_t** fifo) {
+    if (!is_connected_to_channel_no_lock(channel_id)) {
+        return KELP_NOT_CONNECTED;
+    }
+
+    *fifo = fifo_incoming(channel_id);
+    (*fifo)->reading = true;
+
+    __dmb(); // the flag has to be up before we look, see above
+    if (com_channels[channel_id].state != CHANNEL_CONNECTED) {
+        // the channel is going, and any message we had borrowed with it
+        (*fifo)->borrowed = false;
+        (*fifo)->reading = false;
+        return KELP_NOT_CONNECTED;
+    }
+
+    return KELP_OK;
+}
+
+// the flag stays up while a message is borrowed
+static void fifo_stop_reading(channel_fifo_t* fifo) {
+    __dmb(); // we have to be done with the buffer before the freer can see the flag down
+    fifo->reading = fifo->borrowed;
+}
+
+// whether the current task can still use or wait on a channel, the channel spinlock must be held
+static bool channel_open_no_lock(const uint16_t channel_id) {
+    return is_connected_to_channel_no_lock(channel_id) && com_channels[channel_id].state == CHANNEL_CONNECTED;
+}
+
+// whether either end of a channel is still using its buffers.
+// an end whose task no longer exists will never put its flags down, so it doesn't count
+static bool channel_in_use_no_lock(const com_channel_t* channel) {
+    __dmb(); // see the flags as they are now the channel is marked closing
+
+    const bool owner_using = channel->fifo_tx.writing || channel->fifo_rx.reading;
+    const bool partner_using = channel->fifo_rx.writing || channel->fifo_tx.reading;
+
+    return (owner_using && task_exists(channel->owner->id)) || (partner_using && task_exists(channel->partner->id));
+}
+
+kelp_error_t channel_free_no_check(const uint16_t channel_id) {
+    com_channel_t* channel = &com_channels[channel_id];
+
+    if (channel->state != CHANNEL_CLOSING) {
+        channel->state = CHANNEL_CLOSING;
+
+        // anyone waiting on it finds out it is going
+        wait_queue_wake_all(&channel->fifo_rx.readers);
+        wait_queue_wake_all(&channel->fifo_rx.writers);
+        wait_queue_wake_all(&channel->fifo_tx.readers);
+        wait_queue_wake_all(&channel->fifo_tx.writers);
+    }
+
+    if (channel_in_use_no_lock(channel)) {
+        return KELP_BUSY;
+    }
+
+    // empty channel of contents to prevent spying
+    memset(channel->fifo_rx.bytes, 0, CHANNEL_BUFFER_SIZE);
+    memset(channel->fifo_tx.bytes, 0, CHANNEL_BUFFER_SIZE);
+
+    fifo_reset(&channel->fifo_rx);
+    fifo_reset(&channel->fifo_tx);
+    channel->fifo_rx.writing = channel->fifo_rx.reading = false;
+    channel->fifo_tx.writing = channel->fifo_tx.reading = false;
+
+    // free channel
+    channel->state = CHANNEL_FREE;
+    channel->can_auto_free = false;
+    channel->inactivity_cooldown = 0;
+
+    TRACE_EVENT(TRACE_CHANNEL_FREE, 0, channel_id, 0, 0);
+    return KELP_OK;
+}
+
+// wake a task blocked on the other end of a fifo, only taking the spinlock if someone is there.
+// the waiter queues itself and then checks the fifo again, while we changed the fifo and then check for waiters,
+// so with a barrier in between at least one of us sees the other
+static void fifo_wake(const uint16_t channel_id, wait_queue_t* queue) {
+    __dmb();
+
+    if (queue->head == NULL) {
+        return;
+    }
+
+    const uint32_t saved_irq = channel_spin_lock(channel_id);
+    wait_queue_wake_one(queue);
+    channel_spin_unlock(channel_id, saved_irq);
+}
+
 kelp_error_t channel_garbage_collect() {
     // go through all the channels,
     // and check if they can be automatically removed
+    // (it runs in the kernel worker task, which owns none of them, so it frees them without the owner check)
 
     for (uint16_t c = 0; c < NUM_CHANNELS; c++) {
+        const uint32_t saved_irq = global_channel_spin_lock();
         channel_spin_lock_unsafe(c);
         com_channel_t* channel = &com_channels[c];
 
         if (channel->state == CHANNEL_FREE) {
             channel_spin_unlock_unsafe(c);
+            global_channel_spin_unlock(saved_irq);
             continue;
         }
 
-        // remove it if it's owner no longer exists
-        if (!task_exists(channel->owner->id)) {
-            channel_spin_unlock_unsafe(c);
-            com_channel_free(c);
-            continue;
+        // finish freeing it if an end was still using it last time,
+        // and remove it if it's owner no longer exists
+        if (channel->state == CHANNEL_CLOSING || !task_exists(channel->owner->id)) {
+            channel_free_no_check(c);
         }
 
         // remove it if it's set to auto free
-        if (channel->can_auto_free) {
+        else if (channel->can_auto_free) {
             if (channel->inactivity_cooldown <= 0) {
-                channel_spin_unlock_unsafe(c);
-                com_channel_free(c);
-                continue;
+                channel_free_no_check(c);
+            }
+            else {
+                channel->inactivity_cooldown -= CHANNEL_GARBAGE_COLLECT_PERIOD;
             }
-
-            channel->inactivity_cooldown -= CHANNEL_GARBAGE_COLLECT_PERIOD;
         }
+
         channel_spin_unlock_unsafe(c);
+        global_channel_spin_unlock(saved_irq);
     }
     return KELP_OK;
 }
@@ -58,14 +303,14 @@ kelp_error_t init_channels() {
         com_channel_t* channel = &com_channels[c];
         channel->state = CHANNEL_FREE;
 
-        void* rx_memory = malloc(sizeof(uint8_t) * CHANNEL_SIZE);
+        void* rx_memory = malloc(sizeof(uint8_t) * CHANNEL_BUFFER_SIZE);
         if (rx_memory == NULL) {
             channel_spin_unlock_unsafe(c);
             global_channel_spin_unlock(saved_irq);
             return KELP_MEMORY;
         }
 
-        void* tx_memory = malloc(sizeof(uint8_t) * CHANNEL_SIZE);
+        void* tx_memory = malloc(sizeof(uint8_t) * CHANNEL_BUFFER_SIZE);
         if (tx_memory == NULL) {
             free(rx_memory);
             channel_spin_unlock_unsafe(c);
@@ -258,21 +503,20 @@ kelp_error_t com_channel_request(uint32_t with_pid, bool autoFree, uint16_t* cha
     channel->owner = current_task;
     channel->partner = with;
 
-    for (uint32_t i = 0; i < CHANNEL_SIZE; ++i) {
+    for (uint32_t i = 0; i < CHANNEL_BUFFER_SIZE; ++i) {
         channel->fifo_rx.bytes[i] = 0;
         channel->fifo_tx.bytes[i] = 0;
     }
 
-    channel->fifo_rx.count = 0;
-    channel->fifo_tx.count = 0;
-
-    channel->fifo_rx.full = 0;
-    channel->fifo_tx.full = 0;
+    fifo_reset(&channel->fifo_rx);
+    fifo_reset(&channel->fifo_tx);
 
     channel->state = CHANNEL_CONNECTED;
     channel->can_auto_free = autoFree;
     channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
 
+    TRACE_EVENT(TRACE_CHANNEL_CONNECT, 0, *channel_id, current_task->id, with_pid);
+
     channel_spin_unlock_unsafe(*channel_id);
     global_channel_spin_unlock(saved_irq);
     return KELP_OK;
@@ -292,323 +536,422 @@ kelp_error_t com_channel_request_blocking(uint32_t with_pid, bool autoFree, uint
 }
 
 kelp_error_t com_channel_free(uint16_t channel_id) {
-    const uint32_t saved_irq = global_channel_spin_lock();
-    channel_spin_lock_unsafe(channel_id);
+    // an end may be in the middle of using the channel, which it can't be for long, so give it a moment to finish
+    for (uint32_t waited_ms = 0; ; waited_ms++) {
+        const uint32_t saved_irq = global_channel_spin_lock();
+        channel_spin_lock_unsafe(channel_id);
+
+        // check if channel exists
+        if (channel_id >= NUM_CHANNELS) {
+            channel_spin_unlock_unsafe(channel_id);
+            global_channel_spin_unlock(saved_irq);
+            return KELP_INVALID_ID;
+        }
 
-    // check if channel exists
-    if (channel_id >= NUM_CHANNELS) {
-        channel_spin_unlock_unsafe(channel_id);
-        global_channel_spin_unlock(saved_irq);
-        return KELP_INVALID_ID;
-    }
+        com_channel_t* channel = &com_channels[channel_id];
 
-    // check if the current task is owner of the channel
-    if (!is_owner_of_channel_no_lock(channel_id)) {
-        channel_spin_unlock_unsafe(channel_id);
-        global_channel_spin_unlock(saved_irq);
-        return KELP_NOT_OWNER;
-    }
+        // it was closing when we let go of it, and someone else finished freeing it since
+        if (waited_ms > 0 && channel->state != CHANNEL_CLOSING) {
+            channel_spin_unlock_unsafe(channel_id);
+            global_channel_spin_unlock(saved_irq);
+            return KELP_OK;
+        }
 
-    com_channel_t* channel = &com_channels[channel_id];
+        // check if the current task is owner of the channel
+        if (!is_owner_of_channel_no_lock(channel_id)) {
+            channel_spin_unlock_unsafe(channel_id);
+            global_channel_spin_unlock(saved_irq);
+            return KELP_NOT_OWNER;
+        }
 
-    if (channel->state == CHANNEL_FREE) {
-        channel_spin_unlock_unsafe(channel_id);
-        global_channel_spin_unlock(saved_irq);
-        return KELP_UNALLOCATED;
-    }
+        if (channel->state == CHANNEL_FREE) {
+            channel_spin_unlock_unsafe(channel_id);
+            global_channel_spin_unlock(saved_irq);
+            return KELP_UNALLOCATED;
+        }
 
-    // empty channel of contents to prevent spying
-    memset(channel->fifo_rx.bytes, 0, CHANNEL_SIZE);
-    memset(channel->fifo_tx.bytes, 0, CHANNEL_SIZE);
+        // a slot or message the owner still has goes with the channel, it would wait for itself otherwise
+        if (get_current_task() == channel->owner) {
+            channel->fifo_tx.loaned = false;
+            channel->fifo_tx.writing = false;
+            channel->fifo_rx.borrowed = false;
+            channel->fifo_rx.reading = false;
+        }
 
-    channel->fifo_rx.count = 0;
-    channel->fifo_tx.count = 0;
+        const kelp_error_t error = channel_free_no_check(channel_id);
 
-    channel->fifo_rx.full = 0;
-    channel->fifo_tx.full = 0;
+        channel_spin_unlock_unsafe(channel_id);
+        global_channel_spin_unlock(saved_irq);
 
-    // free channel
-    channel->state = CHANNEL_FREE;
-    channel->can_auto_free = false;
-    channel->inactivity_cooldown = 0;
+        // only tasks can wait, anyone else can try again later
+        if (error != KELP_BUSY || is_privileged() || waited_ms >= CHANNEL_BLOCKING_TIMEOUT_MS) {
+            return error;
+        }
 
-    channel_spin_unlock_unsafe(channel_id);
-    global_channel_spin_unlock(saved_irq);
-    return KELP_OK;
+        task_sleep_ms(1);
+    }
 }
 
 bool is_channel_ready_to_write(const uint16_t channel_id) {
-    const uint32_t saved_irq = channel_spin_lock(channel_id);
-
     if (!is_connected_to_channel_no_lock(channel_id)) {
-        channel_spin_unlock(channel_id, saved_irq);
-        return false;
-    }
-
-    com_channel_t* channel = &com_channels[channel_id];
-    channel_fifo_t* fifo;
-
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_tx;
-    }
-    else {
-        fifo = &channel->fifo_rx;
-    }
-
-    if (fifo->full) {
-        channel_spin_unlock(channel_id, saved_irq);
         return false;
     }
 
-    channel_spin_unlock(channel_id, saved_irq);
-    return true;
+    return fifo_fits(fifo_outgoing(channel_id), CHANNEL_SIZE);
 }
 
 kelp_error_t com_channel_write(uint16_t channel_id, const uint8_t* bytes, uint16_t size) {
-    const uint32_t saved_irq = channel_spin_lock(channel_id);
-
     if (size > CHANNEL_SIZE) {
-        channel_spin_unlock(channel_id, saved_irq);
         return KELP_TOO_BIG;
     }
 
-    if (!is_connected_to_channel_no_lock(channel_id)) {
-        channel_spin_unlock(channel_id, saved_irq);
-        return KELP_NOT_CONNECTED;
-    }
+    channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_writing(channel_id, &fifo));
 
     com_channel_t* channel = &com_channels[channel_id];
-    channel_fifo_t* fifo;
 
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_tx;
-    }
-    else {
-        fifo = &channel->fifo_rx;
+    // the lent slot is where this message would go
+    if (fifo->loaned) {
+        fifo_stop_writing(fifo);
+        return KELP_BUSY;
     }
 
-    if (fifo->full) {
-        channel_spin_unlock(channel_id, saved_irq);
+    uint32_t position;
+    if (!fifo_reserve(fifo, size, &position)) {
+        fifo_stop_writing(fifo);
         return KELP_CHANNEL_FULL;
     }
 
-    memcpy(fifo->bytes, bytes, size);
-
-    fifo->count = size;
-    fifo->full = 1;
+    memcpy(fifo_at(fifo, position + CHANNEL_HEADER_SIZE), bytes, size);
+    fifo_publish(fifo, position, size);
     channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
+    TRACE_EVENT(TRACE_CHANNEL_WRITE, 0, channel_id, size, 0);
+    fifo_stop_writing(fifo);
 
-    channel_spin_unlock(channel_id, saved_irq);
+    fifo_wake(channel_id, &fifo->readers);
     return KELP_OK;
 }
 
 kelp_error_t com_channel_write_blocking(uint16_t channel_id, const uint8_t* bytes, uint16_t size) {
-    com_channel_wait_until_writable(channel_id);
+    if (size > CHANNEL_SIZE) {
+        return KELP_TOO_BIG;
+    }
+
+    KELP_RETURN_ON_ERROR(channel_wait_for_room(channel_id, size));
 
     return com_channel_write(channel_id, bytes, size);
 }
 
 bool is_channel_ready_to_read(const uint16_t channel_id) {
-    const uint32_t saved_irq = channel_spin_lock(channel_id);
-
     if (!is_connected_to_channel_no_lock(channel_id)) {
-        channel_spin_unlock(channel_id, saved_irq);
         return false;
     }
 
-    com_channel_t* channel = &com_channels[channel_id];
+    return fifo_has_message(fifo_incoming(channel_id));
+}
+
+kelp_error_t com_channel_read(uint16_t channel_id, uint8_t* buffer, uint16_t* read, uint16_t size) {
     channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_reading(channel_id, &fifo));
 
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_rx;
-    }
-    else {
-        fifo = &channel->fifo_tx;
+    com_channel_t* channel = &com_channels[channel_id];
+
+    if (!fifo_has_message(fifo)) {
+        fifo_stop_reading(fifo);
+        return KELP_CHANNEL_EMPTY;
     }
 
-    if (!fifo->full) {
-        channel_spin_unlock(channel_id, saved_irq);
-        return false;
+    const uint16_t message_size = fifo_front_size(fifo);
+
+    if (size < message_size) {
+        fifo_stop_reading(fifo);
+        return KELP_TOO_BIG;
     }
 
-    channel_spin_unlock(channel_id, saved_irq);
-    return true;
+    memcpy(buffer, fifo_front(fifo), message_size);
+    fifo_pop(fifo);
+
+    *read = message_size;
+    channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
+    TRACE_EVENT(TRACE_CHANNEL_READ, 0, channel_id, message_size, 0);
+    fifo_stop_reading(fifo);
+
+    fifo_wake(channel_id, &fifo->writers);
+    return KELP_OK;
 }
 
-kelp_error_t com_channel_read(uint16_t channel_id, uint8_t* buffer, uint16_t* read, uint16_t size) {
-    uint32_t saved_irq = channel_spin_lock(channel_id);
+kelp_error_t com_channel_read_blocking(uint16_t channel_id, uint8_t* buffer, uint16_t* read, uint16_t size) {
+    KELP_RETURN_ON_ERROR(com_channel_wait_until_readable(channel_id));
 
-    if (!is_connected_to_channel_no_lock(channel_id)) {
-        channel_spin_unlock(channel_id, saved_irq);
-        return KELP_NOT_CONNECTED;
-    }
+    return com_channel_read(channel_id, buffer, read, size);
+}
 
-    com_channel_t* channel = &com_channels[channel_id];
+kelp_error_t com_channel_read_no_reset(uint16_t channel_id, uint8_t* buffer, uint16_t* read, uint16_t size) {
     channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_reading(channel_id, &fifo));
 
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_rx;
-    }
-    else {
-        fifo = &channel->fifo_tx;
-    }
+    com_channel_t* channel = &com_channels[channel_id];
 
-    if (!fifo->full) {
-        channel_spin_unlock(channel_id, saved_irq);
+    if (!fifo_has_message(fifo)) {
+        fifo_stop_reading(fifo);
         return KELP_CHANNEL_EMPTY;
     }
 
-    uint32_t fifo_count = fifo->count;
+    const uint16_t message_size = fifo_front_size(fifo);
 
-    if (size < fifo_count) {
-        channel_spin_unlock(channel_id, saved_irq);
+    if (size < message_size) {
+        fifo_stop_reading(fifo);
         return KELP_TOO_BIG;
     }
 
-    memcpy(buffer, fifo->bytes, fifo_count);
+    memcpy(buffer, fifo_front(fifo), message_size);
 
-    *read = fifo_count;
-    fifo->count = 0;
-    fifo->full = 0;
+    *read = message_size;
     channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
+    fifo_stop_reading(fifo);
 
-    channel_spin_unlock(channel_id, saved_irq);
     return KELP_OK;
 }
 
-kelp_error_t com_channel_read_blocking(uint16_t channel_id, uint8_t* buffer, uint16_t* read, uint16_t size) {
-    com_channel_wait_until_readable(channel_id);
+kelp_error_t com_channel_peek(uint16_t channel_id, uint8_t* byte) {
+    channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_reading(channel_id, &fifo));
 
-    return com_channel_read(channel_id, buffer, read, size);
-}
+    com_channel_t* channel = &com_channels[channel_id];
 
-kelp_error_t com_channel_read_no_reset(uint16_t channel_id, uint8_t* buffer, uint16_t* read, uint16_t size) {
-    uint32_t saved_irq = channel_spin_lock(channel_id);
+    if (!fifo_has_message(fifo) || fifo_front_size(fifo) < 1) {
+        fifo_stop_reading(fifo);
+        return KELP_CHANNEL_EMPTY;
+    }
 
-    if (!is_connected_to_channel_no_lock(channel_id)) {
-        channel_spin_unlock(channel_id, saved_irq);
-        return KELP_NOT_CONNECTED;
+    *byte = fifo_front(fifo)[0];
+
+    channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
+    fifo_stop_reading(fifo);
+
+    return KELP_OK;
+}
+
+kelp_error_t com_channel_acquire(uint16_t channel_id, uint16_t size, uint8_t** slot) {
+    if (size > CHANNEL_SIZE) {
+        return KELP_TOO_BIG;
     }
 
-    com_channel_t* channel = &com_channels[channel_id];
     channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_writing(channel_id, &fifo));
 
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_rx;
-    }
-    else {
-        fifo = &channel->fifo_tx;
+    if (fifo->loaned) {
+        fifo_stop_writing(fifo);
+        return KELP_BUSY;
     }
 
-    if (!fifo->full) {
-        channel_spin_unlock(channel_id, saved_irq);
-        return KELP_CHANNEL_EMPTY;
+    uint32_t position;
+    if (!fifo_reserve(fifo, size, &position)) {
+        fifo_stop_writing(fifo);
+        return KELP_CHANNEL_FULL;
     }
 
-    uint32_t fifo_count = fifo->count;
+    // nothing is published yet, the reader can't see the slot until it is committed
+    fifo->loan = position;
+    fifo->loan_size = size;
+    fifo->loaned = true;
 
-    if (size < fifo_count) {
-        channel_spin_unlock(channel_id, saved_irq);
+    *slot = fifo_at(fifo, position + CHANNEL_HEADER_SIZE);
+    fifo_stop_writing(fifo);
+    return KELP_OK;
+}
+
+kelp_error_t com_channel_acquire_blocking(uint16_t channel_id, uint16_t size, uint8_t** slot) {
+    if (size > CHANNEL_SIZE) {
         return KELP_TOO_BIG;
     }
 
-    for (int b = 0; b < fifo_count; b++) {
-        buffer[b] = fifo->bytes[b];
+    KELP_RETURN_ON_ERROR(channel_wait_for_room(channel_id, size));
+
+    return com_channel_acquire(channel_id, size, slot);
+}
+
+kelp_error_t com_channel_commit(uint16_t channel_id, uint16_t size) {
+    channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_writing(channel_id, &fifo));
+
+    com_channel_t* channel = &com_channels[channel_id];
+
+    if (!fifo->loaned) {
+        fifo_stop_writing(fifo);
+        return KELP_UNALLOCATED;
     }
 
-    *read = fifo_count;
+    if (size > fifo->loan_size) {
+        fifo_stop_writing(fifo);
+        return KELP_TOO_BIG;
+    }
+
+    fifo->loaned = false;
+    fifo_publish(fifo, fifo->loan, size);
     channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
+    TRACE_EVENT(TRACE_CHANNEL_WRITE, 0, channel_id, size, 0);
+    fifo_stop_writing(fifo);
 
-    channel_spin_unlock(channel_id, saved_irq);
+    fifo_wake(channel_id, &fifo->readers);
     return KELP_OK;
 }
 
-kelp_error_t com_channel_peek(uint16_t channel_id, uint8_t* byte) {
-    uint32_t saved_irq = channel_spin_lock(channel_id);
+kelp_error_t com_channel_discard(uint16_t channel_id) {
+    channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_writing(channel_id, &fifo));
 
-    if (!is_connected_to_channel_no_lock(channel_id)) {
-        channel_spin_unlock(channel_id, saved_irq);
-        return KELP_NOT_CONNECTED;
+    if (!fifo->loaned) {
+        fifo_stop_writing(fifo);
+        return KELP_UNALLOCATED;
     }
 
-    com_channel_t* channel = &com_channels[channel_id];
+    fifo->loaned = false;
+    fifo_stop_writing(fifo);
+    return KELP_OK;
+}
+
+kelp_error_t com_channel_borrow(uint16_t channel_id, const uint8_t** message, uint16_t* size) {
     channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_reading(channel_id, &fifo));
 
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_rx;
-    }
-    else {
-        fifo = &channel->fifo_tx;
-    }
+    com_channel_t* channel = &com_channels[channel_id];
 
-    if (!fifo->full) {
-        channel_spin_unlock(channel_id, saved_irq);
+    if (!fifo_has_message(fifo)) {
+        fifo_stop_reading(fifo);
         return KELP_CHANNEL_EMPTY;
     }
 
-    const uint32_t fifo_count = fifo->count;
+    // the writer never touches a message before the reader moves `head` past it, so it can be read in place
+    *size = fifo_front_size(fifo);
+    *message = fifo_front(fifo);
+    fifo->borrowed = true;
+    channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
+    fifo_stop_reading(fifo);
 
-    if (fifo_count < 1) {
-        channel_spin_unlock(channel_id, saved_irq);
+    return KELP_OK;
+}
+
+kelp_error_t com_channel_borrow_blocking(uint16_t channel_id, const uint8_t** message, uint16_t* size) {
+    KELP_RETURN_ON_ERROR(com_channel_wait_until_readable(channel_id));
+
+    return com_channel_borrow(channel_id, message, size);
+}
+
+kelp_error_t com_channel_release(uint16_t channel_id) {
+    channel_fifo_t* fifo;
+    KELP_RETURN_ON_ERROR(fifo_start_reading(channel_id, &fifo));
+
+    com_channel_t* channel = &com_channels[channel_id];
+
+    if (!fifo_has_message(fifo)) {
+        fifo_stop_reading(fifo);
         return KELP_CHANNEL_EMPTY;
     }
 
-    *byte = fifo->bytes[0];
-
+#if TRACE
+    const uint16_t message_size = fifo_front_size(fifo);
+#endif
+    fifo_pop(fifo);
+    fifo->borrowed = false;
     channel->inactivity_cooldown = CHANNEL_AUTO_FREE_DELAY;
+    TRACE_EVENT(TRACE_CHANNEL_READ, 0, channel_id, message_size, 0);
+    fifo_stop_reading(fifo);
 
-    channel_spin_unlock(channel_id, saved_irq);
+    fifo_wake(channel_id, &fifo->writers);
     return KELP_OK;
 }
 
-void com_channel_wait_until_writable(uint16_t channel_id) {
-    if (!is_connected_to_channel(channel_id)) {
-        return;
+kelp_error_t channel_wait_for_room(uint16_t channel_id, const uint16_t size) {
+    if (is_privileged()) {
+        return KELP_OK; // only tasks can block
     }
 
+    const absolute_time_t timeout = make_timeout_time_ms(CHANNEL_BLOCKING_TIMEOUT_MS);
     uint32_t saved_irq = channel_spin_lock(channel_id);
-    com_channel_t* channel = &com_channels[channel_id];
-    channel_fifo_t* fifo;
+    kelp_error_t error = KELP_OK;
 
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_tx;
-    }
-    else {
-        fifo = &channel->fifo_rx;
-    }
-    channel_spin_unlock(channel_id, saved_irq);
+    // block on the fifo until the reader makes room, the channel is being freed, or we time out
+    while (channel_open_no_lock(channel_id)) {
+        channel_fifo_t* fifo = fifo_outgoing(channel_id);
 
-    for (uint16_t t = 0; t < CHANNEL_BLOCKING_TIMEOUT_MS * 40; t++) {
-        if (!fifo->full) {
+        if (fifo_fits(fifo, size)) {
             break;
         }
 
-        task_sleep_us(25);
+        error = task_wait_prepare(&fifo->writers, timeout);
+        if (error != KELP_OK) {
+            break; // being killed, so it mustn't wait
+        }
+
+        // the reader doesn't take the lock to make room, so look again now that we are queued (see `fifo_wake`)
+        __dmb();
+        if (fifo_fits(fifo, size)) {
+            task_wait_cancel(&fifo->writers);
+            break;
+        }
+
+        channel_spin_unlock(channel_id, saved_irq);
+        scheduler_raise_pendsv();
+        saved_irq = channel_spin_lock(channel_id);
+
+        error = task_wait_finish(&fifo->writers);
+        if (error != KELP_OK) {
+            break;
+        }
     }
+
+    channel_spin_unlock(channel_id, saved_irq);
+
+    // running out of time leaves the caller to find the channel still full or empty
+    return error == KELP_KILLED ? KELP_KILLED : KELP_OK;
 }
 
-void com_channel_wait_until_readable(uint16_t channel_id) {
-    if (!is_connected_to_channel(channel_id)) {
-        return;
+kelp_error_t com_channel_wait_until_writable(uint16_t channel_id) {
+    return channel_wait_for_room(channel_id, CHANNEL_SIZE);
+}
+
+kelp_error_t com_channel_wait_until_readable(uint16_t channel_id) {
+    if (is_privileged()) {
+        return KELP_OK; // only tasks can block
     }
 
+    const absolute_time_t timeout = make_timeout_time_ms(CHANNEL_BLOCKING_TIMEOUT_MS);
     uint32_t saved_irq = channel_spin_lock(channel_id);
-    com_channel_t* channel = &com_channels[channel_id];
-    channel_fifo_t* fifo;
+    kelp_error_t error = KELP_OK;
 
-    if (is_owner_of_channel_no_lock(channel_id)) {
-        fifo = &channel->fifo_rx;
-    }
-    else {
-        fifo = &channel->fifo_tx;
-    }
-    channel_spin_unlock(channel_id, saved_irq);
+    // block on the fifo until the writer fills it, the channel is being freed, or we time out
+    while (channel_open_no_lock(channel_id)) {
+        channel_fifo_t* fifo = fifo_incoming(channel_id);
+
+        if (fifo_has_message(fifo)) {
+            break;
+        }
 
-    for (uint16_t t = 0; t < CHANNEL_BLOCKING_TIMEOUT_MS * 40; t++) {
-        if (fifo->full) {
+        error = task_wait_prepare(&fifo->readers, timeout);
+        if (error != KELP_OK) {
+            break; // being killed, so it mustn't wait
+        }
+
+        // the writer doesn't take the lock to publish, so look again now that we are queued (see `fifo_wake`)
+        __dmb();
+        if (fifo_has_message(fifo)) {
+            task_wait_cancel(&fifo->readers);
             break;
         }
 
-        task_sleep_us(25);
+        channel_spin_unlock(channel_id, saved_irq);
+        scheduler_raise_pendsv();
+        saved_irq = channel_spin_lock(channel_id);
+
+        error = task_wait_finish(&fifo->readers);
+        if (error != KELP_OK) {
+            break;
+        }
     }
-}
\ No newline at end of file
+
+    channel_spin_unlock(channel_id, saved_irq);
+
+    // running out of time leaves the caller to find the channel still full or empty
+    return error == KELP_KILLED ? KELP_KILLED : KELP_OK;
+}
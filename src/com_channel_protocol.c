@@ -374,9 +374,6 @@ kelp_error_t com_send_char_array(const uint16_t channel_id, const char data[], u
 
     // send the data packets
     for (uint16_t p = 0; p < packet_count; p++) {
-        // wait for the previous packet to be received
-        com_channel_wait_until_writable(channel_id);
-
         const uint32_t data_left = size - p * data_size;
         uint16_t data_this_packet = data_size;
 
@@ -385,13 +382,18 @@ kelp_error_t com_send_char_array(const uint16_t channel_id, const char data[], u
             data_this_packet = data_left;
         }
 
-        uint8_t data_packet[prefix_size + data_this_packet];
+        // wait for room for this packet, and build it right in the channel
+        uint8_t* data_packet = NULL;
+        error = com_channel_acquire_blocking(channel_id, prefix_size + data_this_packet, &data_packet);
+        if (error != KELP_OK) {
+            return error;
+        }
 
         data_packet[0] = COM_TYPE_STR_D;
 
         memcpy(&data_packet[prefix_size], &data[p * data_size], data_this_packet);
 
-        error = com_channel_write(channel_id, data_packet, prefix_size + data_this_packet);
+        error = com_channel_commit(channel_id, prefix_size + data_this_packet);
         if (error != KELP_OK) {
             return error;
         }
@@ -426,9 +428,6 @@ kelp_error_t com_get_char_array(uint16_t channel_id, char* data, uint32_t max_si
     const uint16_t packet_count = initial_packet[7] << 8 | initial_packet[8];
     // receive the data packets
     for (uint16_t p = 0; p < packet_count; p++) {
-        // wait for the previous packet to be received
-        com_channel_wait_until_readable(channel_id);
-
         const uint32_t data_left = *size - p * data_size;
         uint16_t data_this_packet = data_size;
 
@@ -437,21 +436,34 @@ kelp_error_t com_get_char_array(uint16_t channel_id, char* data, uint32_t max_si
             data_this_packet = data_left;
         }
 
-        // don't simplify prefix_size + data_this_packet to CHANNEL_SIZE
-        // as data_this_packet != data_size
-        uint8_t data_packet[prefix_size + data_this_packet];
+        // wait for the next packet to arrive, and copy straight out of the channel
+        const uint8_t* data_packet = NULL;
         uint16_t data_packet_size = 0;
 
-        error = com_channel_read(channel_id, data_packet, &data_packet_size, prefix_size + data_this_packet);
+        error = com_channel_borrow_blocking(channel_id, &data_packet, &data_packet_size);
         if (error != KELP_OK) {
             // there was an error
             return error;
         }
 
-        if (data_packet[0] != COM_TYPE_STR_D) {
+        // don't simplify prefix_size + data_this_packet to CHANNEL_SIZE
+        // as data_this_packet != data_size
+        if (data_packet_size > prefix_size + data_this_packet) {
+            com_channel_release(channel_id);
+            return KELP_TOO_BIG;
+        }
+
+        if (data_packet_size < prefix_size || data_packet[0] != COM_TYPE_STR_D) {
+            com_channel_release(channel_id);
             return KELP_WRONG_TYPE; // wrong data type
         }
 
+        // a short packet would have memcpy read past what the sender wrote
+        if (data_packet_size < prefix_size + data_this_packet) {
+            com_channel_release(channel_id);
+            return KELP_PROTOCOL; // protocol error
+        }
+
         if (p * data_size + data_this_packet > max_size) {
             // shrink data_this_packet when there isn't enough room
             uint32_t total_read = p * data_size;
@@ -459,6 +471,7 @@ kelp_error_t com_get_char_array(uint16_t channel_id, char* data, uint32_t max_si
         }
 
         memcpy(&data[p * data_size], &data_packet[prefix_size], data_this_packet);
+        com_channel_release(channel_id);
     }
 
     if (*size > max_size) {
@@ -476,39 +489,40 @@ kelp_error_t com_send_char_array_fast(const uint16_t channel_id, const char* dat
         return KELP_TOO_BIG; // array too big, increase channel size, or decrease array size
     }
 
-    uint8_t bytes[packet_size];
+    uint8_t* bytes = NULL;
+    kelp_error_t error = com_channel_acquire(channel_id, packet_size, &bytes);
+    KELP_RETURN_ON_ERROR(error);
 
     bytes[0] = COM_TYPE_ARRAY;
     bytes[1] = reason >> 8;
     bytes[2] = reason;
 
-    for (uint16_t i = 0; i < size; i++) {
-        bytes[3 + i] = data[i];
-    }
+    memcpy(&bytes[3], data, size);
 
-    kelp_error_t error = com_channel_write(channel_id, bytes, packet_size);
+    error = com_channel_commit(channel_id, packet_size);
     return error;
 }
 
 kelp_error_t com_get_char_array_fast(const uint16_t channel_id, char (*data)[CHANNEL_SIZE], uint16_t* size, uint16_t* reason) {
     // TODO: How the HECK I'm I SUPPOSED to pass a pointer to an ARRAY! >:(
 
-    uint8_t bytes[CHANNEL_SIZE];
+    const uint8_t* bytes = NULL;
+    uint16_t packet_size = 0;
 
-    kelp_error_t error = com_channel_read(channel_id, bytes, size, CHANNEL_SIZE);
-    *size -= 3;
+    kelp_error_t error = com_channel_borrow(channel_id, &bytes, &packet_size);
     KELP_RETURN_ON_ERROR(error);
 
-    if (bytes[0] != COM_TYPE_ARRAY) {
+    if (packet_size < 3 || bytes[0] != COM_TYPE_ARRAY) {
+        com_channel_release(channel_id);
         return KELP_WRONG_TYPE; // wrong data type
     }
 
+    *size = packet_size - 3;
     *reason = bytes[1] << 8 | bytes[2];
 
-    for (uint16_t i = 0; i < *size; i++) {
-        (*data)[i] = bytes[3 + i];
-    }
+    memcpy(*data, &bytes[3], *size);
 
+    com_channel_release(channel_id);
     return KELP_OK;
 }
 
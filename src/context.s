@@ -9,8 +9,8 @@
 .extern get_current_task
 .extern get_next_task
 .extern hard_fault_handler_c
-.extern scheduler_spin_lock
-.extern scheduler_spin_unlock
+.extern run_queue_spin_lock_this_core
+.extern run_queue_spin_unlock_this_core
 
 .global _cpsid
 .type _cpsid, %function
@@ -58,7 +58,7 @@ priviliged_true:
 .type PendSV_Handler, %function
 
 PendSV_Handler:
-    blx scheduler_spin_lock // aquire spinlock
+    blx run_queue_spin_lock_this_core // aquire this core's run queue spinlock
     mov r3, r0              // save interrupts to r3 (I love you r3 ♡)
 
     blx scheduler_is_started // get whether this core's scheduler is started or not
@@ -113,7 +113,7 @@ first_context_switch:       // skip here if this is the first time running, as t
     isb
 
     mov r0, r3              // grab saved interrupts
-    blx scheduler_spin_unlock   // release spinlock
+    blx run_queue_spin_unlock_this_core // release spinlock
 
     ldr r0, =0xFFFFFFFD     // load `0xFFFFFFFD` (special address to tell cpu to go back to process mode)
     bx r0                   // and go there, exiting
@@ -129,6 +129,7 @@ first_context_switch:       // skip here if this is the first time running, as t
 // and cannot be trusted. This trampoline figures out whether the frame was
 // stacked on the MSP or PSP (via bit 2 of the EXC_RETURN value in LR), then
 // passes a pointer to that frame to a C handler for decoding/printing.
+// The handler may also return, which returns from the fault (see STACK_GUARD_MPU).
 HardFault_Handler:
     movs r0, #4
     mov r1, lr
@@ -0,0 +1,94 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "counting_semaphore.h"
+
+#include <stddef.h>
+
+#include "pico/time.h"
+#include "scheduler_internal.h"
+#include "spinlock_internal.h"
+
+static kelp_error_t semaphore_take_until(kelp_semaphore_t* semaphore, const absolute_time_t until) {
+    if (is_privileged()) {
+        return KELP_NOT_SUPPORTED; // only tasks can block
+    }
+
+    uint32_t saved_irq = sync_spin_lock();
+    kelp_error_t error = KELP_OK;
+
+    // a waiter is only woken, not handed the unit, so it has to look again (another task may have taken it first).
+    // the count is checked before the timeout, so a unit given just as we timed out isn't left behind
+    while (semaphore->count == 0) {
+        // it timed out, or is being killed
+        if (error != KELP_OK) {
+            sync_spin_unlock(saved_irq);
+            return error;
+        }
+
+        error = task_wait_prepare(&semaphore->waiters, until);
+        if (error != KELP_OK) {
+            sync_spin_unlock(saved_irq);
+            return error; // being killed, so it mustn't wait
+        }
+
+        sync_spin_unlock(saved_irq);
+        scheduler_raise_pendsv();
+        saved_irq = sync_spin_lock();
+
+        error = task_wait_finish(&semaphore->waiters);
+    }
+
+    semaphore->count--;
+
+    sync_spin_unlock(saved_irq);
+    return KELP_OK;
+}
+
+void kelp_semaphore_init(kelp_semaphore_t* semaphore, const uint32_t initial, const uint32_t max) {
+    semaphore->count = initial < max ? initial : max;
+    semaphore->max = max;
+    wait_queue_init(&semaphore->waiters);
+}
+
+kelp_error_t kelp_semaphore_take(kelp_semaphore_t* semaphore) {
+    return semaphore_take_until(semaphore, at_the_end_of_time);
+}
+
+kelp_error_t kelp_semaphore_take_timeout(kelp_semaphore_t* semaphore, const uint64_t timeout_us) {
+    return semaphore_take_until(semaphore, make_timeout_time_us(timeout_us));
+}
+
+kelp_error_t kelp_semaphore_try_take(kelp_semaphore_t* semaphore) {
+    const uint32_t saved_irq = sync_spin_lock();
+
+    if (semaphore->count == 0) {
+        sync_spin_unlock(saved_irq);
+        return KELP_BUSY;
+    }
+
+    semaphore->count--;
+
+    sync_spin_unlock(saved_irq);
+    return KELP_OK;
+}
+
+kelp_error_t kelp_semaphore_give(kelp_semaphore_t* semaphore) {
+    const uint32_t saved_irq = sync_spin_lock();
+
+    if (semaphore->count >= semaphore->max) {
+        sync_spin_unlock(saved_irq);
+        return KELP_TOO_BIG;
+    }
+
+    semaphore->count++;
+    wait_queue_wake_one(&semaphore->waiters);
+
+    sync_spin_unlock(saved_irq);
+    return KELP_OK;
+}
+
+uint32_t kelp_semaphore_get_count(const kelp_semaphore_t* semaphore) {
+    return semaphore->count;
+}
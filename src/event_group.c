@@ -0,0 +1,136 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "event_group.h"
+
+#include <stddef.h>
+
+#include "pico/time.h"
+#include "scheduler_internal.h"
+#include "spinlock_internal.h"
+
+static inline bool bits_satisfy(const uint32_t set, const uint32_t bits, const uint8_t flags) {
+    if (flags & KELP_EVENT_WAIT_ALL) {
+        return (set & bits) == bits;
+    }
+
+    return (set & bits) != 0;
+}
+
+static kelp_error_t event_group_wait_until(kelp_event_group_t* group, const uint32_t bits, const uint8_t flags,
+                                           const absolute_time_t until, uint32_t* set) {
+    if (is_privileged()) {
+        return KELP_NOT_SUPPORTED; // only tasks can block
+    }
+
+    if (bits == 0) {
+        return KELP_ERROR;
+    }
+
+    task_t* task = get_current_task();
+    uint32_t saved_irq = sync_spin_lock();
+
+    if (bits_satisfy(group->bits, bits, flags)) {
+        if (set != NULL) {
+            *set = group->bits;
+        }
+        if (flags & KELP_EVENT_CLEAR) {
+            group->bits &= ~bits;
+        }
+
+        sync_spin_unlock(saved_irq);
+        return KELP_OK;
+    }
+
+    task->wait_bits = bits;
+    task->wait_flags = flags;
+    kelp_error_t error = task_wait_prepare(&group->waiters, until);
+
+    if (error != KELP_OK) {
+        // being killed, so it mustn't wait
+        if (set != NULL) {
+            *set = group->bits;
+        }
+
+        sync_spin_unlock(saved_irq);
+        return error;
+    }
+
+    sync_spin_unlock(saved_irq);
+    scheduler_raise_pendsv();
+    saved_irq = sync_spin_lock();
+
+    // only a set that satisfies a waiter takes it out of the queue, and it already cleared the bits for it,
+    // so still being in the queue is the only way to have timed out (or been made ready to die)
+    const bool satisfied = task->wait_queue != &group->waiters;
+    error = task_wait_finish(&group->waiters);
+
+    if (set != NULL) {
+        *set = satisfied ? task->wait_bits : group->bits;
+    }
+
+    sync_spin_unlock(saved_irq);
+    return satisfied ? KELP_OK : error;
+}
+
+void kelp_event_group_init(kelp_event_group_t* group) {
+    group->bits = 0;
+    wait_queue_init(&group->waiters);
+}
+
+uint32_t kelp_event_group_set(kelp_event_group_t* group, const uint32_t bits) {
+    const uint32_t saved_irq = sync_spin_lock();
+
+    group->bits |= bits;
+
+    // every waiter is judged by the bits as they were set, what they clear only goes once all of them are woken
+    uint32_t to_clear = 0;
+    task_t* task = group->waiters.head;
+
+    while (task != NULL) {
+        task_t* next = task->wait_next;
+
+        if (bits_satisfy(group->bits, task->wait_bits, task->wait_flags)) {
+            if (task->wait_flags & KELP_EVENT_CLEAR) {
+                to_clear |= task->wait_bits;
+            }
+
+            // the waiter may have just timed out, it is still given the bits as it finds itself out of the queue
+            task->wait_bits = group->bits;
+            wait_queue_wake_task(&group->waiters, task);
+        }
+
+        task = next;
+    }
+
+    group->bits &= ~to_clear;
+    const uint32_t result = group->bits;
+
+    sync_spin_unlock(saved_irq);
+    return result;
+}
+
+uint32_t kelp_event_group_clear(kelp_event_group_t* group, const uint32_t bits) {
+    const uint32_t saved_irq = sync_spin_lock();
+
+    const uint32_t result = group->bits;
+    group->bits &= ~bits;
+
+    sync_spin_unlock(saved_irq);
+    return result;
+}
+
+uint32_t kelp_event_group_get(const kelp_event_group_t* group) {
+    return group->bits;
+}
+
+kelp_error_t kelp_event_group_wait(kelp_event_group_t* group, const uint32_t bits, const uint8_t flags,
+                                   uint32_t* set) {
+    return event_group_wait_until(group, bits, flags, at_the_end_of_time, set);
+}
+
+kelp_error_t kelp_event_group_wait_timeout(kelp_event_group_t* group, const uint32_t bits, const uint8_t flags,
+                                           const uint64_t timeout_us, uint32_t* set) {
+    return event_group_wait_until(group, bits, flags, make_timeout_time_us(timeout_us), set);
+}
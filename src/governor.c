@@ -8,6 +8,7 @@
 #include "kernel_config.h"
 #include "scheduler.h"
 #include "scheduler_internal.h"
+#include "trace_internal.h"
 #include "hardware/clocks.h"
 #include "hardware/timer.h"
 #include "hardware/uart.h"
@@ -106,7 +107,7 @@ void governor_update() {
         // increase voltage before increasing frequency
         if (new_freq > current_freq) {
             vreg_set_voltage(target_voltage);
-            busy_wait_us(100); // let voltage stabilize
+            task_sleep_us(100); // let voltage stabilize (the other tasks can run meanwhile)
         }
 
         if (!set_sys_clock_khz(governor_frequencies[new_freq], false)) {
@@ -123,6 +124,7 @@ void governor_update() {
             vreg_set_voltage(target_voltage);
         }
 
+        TRACE_EVENT(TRACE_CLOCK, 0, 0, governor_frequencies[new_freq], governor_frequencies[current_freq]);
         current_freq = new_freq;
 
         refresh_systick_all_cores();
@@ -0,0 +1,178 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "mutex.h"
+
+#include <stddef.h>
+
+#include "pico/time.h"
+#include "kernel_config.h"
+#include "scheduler_internal.h"
+#include "spinlock_internal.h"
+
+/*
+ * Every mutex shares the sync spinlock, so the owner -> waited on mutex -> its owner chain
+ * can be followed without taking a lock per hop. Run queue locks are taken inside it (see `task_set_priority`).
+ */
+
+// the priority a task is owed: its own, or that of the most important task waiting on a mutex it holds
+static uint8_t inherited_priority(const task_t* task) {
+    uint8_t priority = task->base_priority;
+
+    for (const kelp_mutex_t* mutex = task->held_mutexes; mutex != NULL; mutex = mutex->next_held) {
+        // waiters are kept most important first
+        if (mutex->waiters.head != NULL && mutex->waiters.head->priority > priority) {
+            priority = mutex->waiters.head->priority;
+        }
+    }
+
+    return priority;
+}
+
+// bring a task's priority up (or down) to what it is owed, and pass the change on to whoever it is waiting on.
+// the chain is at most every task long, unless the tasks in it are deadlocked on each other
+static void update_priority(task_t* task) {
+    for (uint32_t hops = 0; task != NULL && hops < MAX_TASKS; hops++) {
+        const uint8_t priority = inherited_priority(task);
+
+        if (priority == task->priority) {
+            return;
+        }
+
+        task_set_priority(task, priority);
+
+        kelp_mutex_t* waiting_for = task->blocked_on;
+        if (waiting_for == NULL) {
+            return;
+        }
+
+        wait_queue_reorder(&waiting_for->waiters, task);
+        task = waiting_for->owner;
+    }
+}
+
+static void mutex_take(kelp_mutex_t* mutex, task_t* task) {
+    mutex->owner = task;
+    mutex->next_held = task->held_mutexes;
+    task->held_mutexes = mutex;
+}
+
+static void mutex_release(kelp_mutex_t* mutex, task_t* task) {
+    kelp_mutex_t** link = &task->held_mutexes;
+    while (*link != mutex) {
+        link = &(*link)->next_held;
+    }
+
+    *link = mutex->next_held;
+    mutex->next_held = NULL;
+    mutex->owner = NULL;
+}
+
+static kelp_error_t mutex_lock_until(kelp_mutex_t* mutex, const absolute_time_t until, const bool wait) {
+    if (is_privileged()) {
+        return KELP_NOT_SUPPORTED; // only tasks can hold a mutex
+    }
+
+    task_t* task = get_current_task();
+    uint32_t saved_irq = sync_spin_lock();
+
+    if (mutex->owner == task) {
+        sync_spin_unlock(saved_irq);
+        return KELP_BUSY;
+    }
+
+    kelp_error_t result = KELP_OK;
+    kelp_error_t waited = KELP_OK; // how the last wait ended
+
+    // unlocking hands the mutex straight to the waiter it wakes, so there is nothing to grab once we are woken
+    while (mutex->owner != task) {
+        if (mutex->owner == NULL) {
+            mutex_take(mutex, task);
+            break;
+        }
+
+        if (!wait) {
+            result = KELP_BUSY;
+            break;
+        }
+
+        // it timed out, or is being killed
+        if (waited != KELP_OK) {
+            update_priority(mutex->owner); // it may not be owed our priority anymore
+            result = waited;
+            break;
+        }
+
+        waited = task_wait_prepare_by_priority(&mutex->waiters, until);
+        if (waited != KELP_OK) {
+            result = waited; // being killed, so it mustn't wait (and never lent its priority)
+            break;
+        }
+
+        task->blocked_on = mutex;
+        update_priority(mutex->owner);
+
+        sync_spin_unlock(saved_irq);
+        scheduler_raise_pendsv();
+        saved_irq = sync_spin_lock();
+
+        waited = task_wait_finish(&mutex->waiters);
+        task->blocked_on = NULL;
+    }
+
+    sync_spin_unlock(saved_irq);
+    return result;
+}
+
+void kelp_mutex_init(kelp_mutex_t* mutex) {
+    mutex->owner = NULL;
+    wait_queue_init(&mutex->waiters);
+    mutex->next_held = NULL;
+}
+
+kelp_error_t kelp_mutex_lock(kelp_mutex_t* mutex) {
+    return mutex_lock_until(mutex, at_the_end_of_time, true);
+}
+
+kelp_error_t kelp_mutex_lock_timeout(kelp_mutex_t* mutex, const uint64_t timeout_us) {
+    return mutex_lock_until(mutex, make_timeout_time_us(timeout_us), true);
+}
+
+kelp_error_t kelp_mutex_try_lock(kelp_mutex_t* mutex) {
+    return mutex_lock_until(mutex, at_the_end_of_time, false);
+}
+
+kelp_error_t kelp_mutex_unlock(kelp_mutex_t* mutex) {
+    if (is_privileged()) {
+        return KELP_NOT_OWNER;
+    }
+
+    task_t* task = get_current_task();
+    const uint32_t saved_irq = sync_spin_lock();
+
+    if (mutex->owner != task) {
+        sync_spin_unlock(saved_irq);
+        return KELP_NOT_OWNER;
+    }
+
+    mutex_release(mutex, task);
+
+    // it can't run before we let go of the sync lock, by which time it owns the mutex
+    task_t* next = wait_queue_wake_next(&mutex->waiters);
+    if (next != NULL) {
+        next->blocked_on = NULL;
+        mutex_take(mutex, next);
+        update_priority(next); // owed whatever is still waiting behind it
+    }
+
+    // back down to what we are still owed, which lets the waiter we woke take over if it outranks us now
+    update_priority(task);
+
+    sync_spin_unlock(saved_irq);
+    return KELP_OK;
+}
+
+bool kelp_mutex_is_held(const kelp_mutex_t* mutex) {
+    return !is_privileged() && mutex->owner == get_current_task();
+}
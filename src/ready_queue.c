@@ -0,0 +1,150 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "ready_queue.h"
+
+#include <stddef.h>
+
+#include "scheduler_internal.h"
+
+// index of the highest set bit, `value` must not be zero
+static inline uint32_t highest_bit(const uint32_t value) {
+    return 31 - __builtin_clz(value);
+}
+
+void ready_queue_init(ready_queue_t *queue) {
+    queue->group_bitmap = 0;
+    queue->count = 0;
+
+    for (uint32_t g = 0; g < READY_QUEUE_GROUPS; g++) {
+        queue->level_bitmap[g] = 0;
+    }
+
+    for (uint32_t l = 0; l < READY_QUEUE_LEVELS; l++) {
+        queue->heads[l] = NULL;
+    }
+}
+
+void ready_queue_push(ready_queue_t *queue, task_t *task) {
+    const uint8_t level = task->priority;
+    task_t *head = queue->heads[level];
+
+    if (head == NULL) {
+        // first task on this level, it links to itself
+        task->queue_next = task;
+        task->queue_prev = task;
+        queue->heads[level] = task;
+
+        queue->level_bitmap[level / 32] |= 1u << (level % 32);
+        queue->group_bitmap |= 1u << (level / 32);
+    }
+    else {
+        // insert just before the head, which is the tail of a circular list
+        task_t *tail = head->queue_prev;
+        task->queue_next = head;
+        task->queue_prev = tail;
+        tail->queue_next = task;
+        head->queue_prev = task;
+    }
+
+    task->queue = TASK_QUEUE_READY;
+    queue->count++;
+}
+
+void ready_queue_remove(ready_queue_t *queue, task_t *task) {
+    const uint8_t level = task->priority;
+
+    if (task->queue_next == task) {
+        // last task on this level
+        queue->heads[level] = NULL;
+
+        queue->level_bitmap[level / 32] &= ~(1u << (level % 32));
+        if (queue->level_bitmap[level / 32] == 0) {
+            queue->group_bitmap &= ~(1u << (level / 32));
+        }
+    }
+    else {
+        task->queue_prev->queue_next = task->queue_next;
+        task->queue_next->queue_prev = task->queue_prev;
+
+        if (queue->heads[level] == task) {
+            queue->heads[level] = task->queue_next;
+        }
+    }
+
+    task->queue_next = NULL;
+    task->queue_prev = NULL;
+    task->queue = TASK_QUEUE_NONE;
+    queue->count--;
+}
+
+task_t *ready_queue_peek(const ready_queue_t *queue) {
+    if (queue->group_bitmap == 0) {
+        return NULL;
+    }
+
+    const uint32_t group = highest_bit(queue->group_bitmap);
+    const uint32_t level = (group * 32) + highest_bit(queue->level_bitmap[group]);
+
+    return queue->heads[level];
+}
+
+int32_t ready_queue_top_priority(const ready_queue_t *queue) {
+    const uint32_t groups = queue->group_bitmap;
+    if (groups == 0) {
+        return -1;
+    }
+
+    const uint32_t group = highest_bit(groups);
+    const uint32_t levels = queue->level_bitmap[group];
+    if (levels == 0) {
+        return -1; // only possible when read while another core is changing the queue
+    }
+
+    return (int32_t)((group * 32) + highest_bit(levels));
+}
+
+task_t *ready_queue_peek_for_core(const ready_queue_t *queue, const uint8_t core, const int32_t min_priority) {
+    uint32_t groups = queue->group_bitmap;
+
+    while (groups != 0) {
+        const uint32_t group = highest_bit(groups);
+        uint32_t levels = queue->level_bitmap[group];
+
+        while (levels != 0) {
+            const uint32_t level_bit = highest_bit(levels);
+            const uint32_t level = (group * 32) + level_bit;
+
+            if ((int32_t)level <= min_priority) {
+                return NULL; // every level left is too low to be wanted
+            }
+
+            task_t *head = queue->heads[level];
+            task_t *task = head;
+
+            do {
+                if (task->affinity & TASK_CORE(core)) {
+                    return task;
+                }
+                task = task->queue_next;
+            } while (task != head);
+
+            levels &= ~(1u << level_bit);
+        }
+
+        groups &= ~(1u << group);
+    }
+
+    return NULL;
+}
+
+task_t *ready_queue_pop(ready_queue_t *queue) {
+    task_t *task = ready_queue_peek(queue);
+
+    if (task != NULL) {
+        ready_queue_remove(queue, task);
+    }
+
+    return task;
+}
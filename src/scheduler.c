@@ -3,6 +3,7 @@
 
 #include "hardware/clocks.h"
 #include "hardware/gpio.h"
+#include "hardware/irq.h"
 #include "pico/time.h"
 #include "hardware/sync.h"
 #include "hardware/structs/systick.h"
@@ -10,22 +11,30 @@
 
 #include "scheduler_internal.h"
 #include "scheduler.h"
+#include "ready_queue.h"
+#include "task_heap.h"
+#include "stack_pool.h"
+#include "stack_guard.h"
+#include "soft_timer.h"
+#include "work_queue.h"
 
 #include <string.h>
 
 #include "channel_internal.h"
 #include "governor.h"
 #include "spinlock_internal.h"
+#include "trace_internal.h"
 #include "kernel_config.h"
 #include "RP2040.h"
 
+#if KERNEL_WORKER_PID < KERNEL_PID_BASE || SOFT_TIMER_PID < KERNEL_PID_BASE || WORK_QUEUE_PID < KERNEL_PID_BASE
+#error "the tasks kernel_start adds have to take ids from KERNEL_PID_BASE up, which task_add_* refuses"
+#endif
+
 /* Scheduler Variables */
 scheduler_t schedulers[CORE_COUNT];
 uint32_t num_tasks;
 task_t tasks[MAX_TASKS];
-#if PROFILE_SCHEDULER
-scheduler_profile_t profile;
-#endif
 
 /* Public Assembly Functions */
 __attribute__((noinline))
@@ -33,6 +42,10 @@ extern void set_spsel(uint32_t control);
 
 extern bool task_exists_no_lock(uint32_t pid);
 
+#if TICKLESS_IDLE
+void update_tick_mode(const task_t* next_task);
+#endif
+
 __attribute__((noinline))
 scheduler_t* get_scheduler() {
     return &schedulers[CORE_NUM];
@@ -54,12 +67,387 @@ void set_scheduler_started(bool started) {
     get_scheduler()->started = started;
 }
 
+bool task_is_running(const task_t* task) {
+    for (uint8_t c = 0; c < CORE_COUNT; c++) {
+        if (schedulers[c].current_task == task) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+// the idle task of a core never leaves it
+static inline bool is_idle_task(const task_t* task) {
+    return task->id < CORE_COUNT;
+}
+
+// the idle tasks and the tasks `kernel_start` adds, which signals can't stop or kill
+static inline bool is_kernel_task(const task_t* task) {
+    return is_idle_task(task) || task->id == KERNEL_WORKER_PID || (SOFT_TIMERS && task->id == SOFT_TIMER_PID) ||
+           (WORK_QUEUE && task->id >= WORK_QUEUE_PID && task->id < WORK_QUEUE_PID + WORK_QUEUE_WORKERS);
+}
+
+#if TRACE
+// the task running on this core, for tracing who did something
+static inline uint32_t current_task_id() {
+    const task_t* task = get_scheduler()->current_task;
+    return task != NULL ? task->id : TRACE_NO_TASK;
+}
+#endif
+
+static inline bool task_allowed_on_core(const task_t* task, const uint8_t core) {
+    return (task->affinity & TASK_CORE(core)) != 0;
+}
+
+#if DEADLINE_SCHEDULING
+// whether a task is picked by its deadline right now, rather than by its priority
+static inline bool task_by_deadline(const task_t* task) {
+    return task->period_us != 0 && !task->throttled;
+}
+#endif
+
+uint32_t task_lock(const task_t* task) {
+    while (true) {
+        const uint8_t core = task->core;
+        const uint32_t saved_irq = run_queue_spin_lock(core);
+
+        // the task may have been stolen by another core while we waited
+        if (task->core == core) {
+            return saved_irq;
+        }
+
+        run_queue_spin_unlock(core, saved_irq);
+    }
+}
+
+void task_unlock(const task_t* task, const uint32_t saved_irq) {
+    run_queue_spin_unlock(task->core, saved_irq);
+}
+
+// ask a core to pick its next task again
+void scheduler_reschedule_core(const uint8_t core) {
+    if (core == CORE_NUM) {
+        scheduler_raise_pendsv();
+    }
+#if CORE_COUNT > 1
+    else {
+        // never block here, we are probably holding locks the other core wants.
+        // if the FIFO is full, the other core has signals waiting that will reschedule it anyway
+        multicore_fifo_push_timeout_us(MULTICORE_SIG_RESCHEDULE, 0);
+    }
+#endif
+}
+
+// whether a ready task should take over from whatever a core is running
+static inline bool task_outranks_core(const task_t* task, const uint8_t core) {
+    const scheduler_t* scheduler = &schedulers[core];
+
+    if (!scheduler->started) {
+        return false; // it picks its first task when it starts anyway
+    }
+
+    const task_t* current_task = scheduler->current_task;
+
+    if (is_idle_task(current_task)) {
+        return true;
+    }
+
+#if DEADLINE_SCHEDULING
+    // deadline tasks outrank every priority task, and each other by the earliest deadline
+    if (task_by_deadline(task)) {
+        return !task_by_deadline(current_task) || task->deadline_us < current_task->deadline_us;
+    }
+    if (task_by_deadline(current_task)) {
+        return false;
+    }
+#endif
+
+    return task->priority > current_task->priority;
+}
+
+// a task just became ready, get it running now if it outranks what its core is running,
+// instead of waiting for the next tick.
+// failing that, poke another core it outranks, which will pull it over in `get_next_task`
+void preempt_for_task(const task_t* task) {
+    if (task_outranks_core(task, task->core)) {
+        scheduler_reschedule_core(task->core);
+        return;
+    }
+
+#if CORE_COUNT > 1
+    for (uint8_t c = 0; c < CORE_COUNT; c++) {
+        if (c != task->core && task_allowed_on_core(task, c) && task_outranks_core(task, c)) {
+            scheduler_reschedule_core(c);
+            return;
+        }
+    }
+#endif
+}
+
+void sleep_queue_insert(task_t* task) {
+    task_heap_push(&schedulers[task->core].sleep_heap, task, to_us_since_boot(task->resume_us));
+    task->queue = TASK_QUEUE_SLEEP;
+}
+
+void sleep_queue_remove(task_t* task) {
+    task_heap_remove(&schedulers[task->core].sleep_heap, task);
+    task->queue = TASK_QUEUE_NONE;
+}
+
+// a killed task can only go once it is out of every wait queue and holds no mutex,
+// as those are protected by locks the scheduler can't take
+static inline bool task_can_die(const task_t* task) {
+    return task->wait_queue == NULL && task->held_mutexes == NULL;
+}
+
+// the kernel acts on TASK_SIGKILL and TASK_SIGSTOP as a task is about to be ready again,
+// `from` is the state it is leaving, for the trace.
+// returns false if the task died or stopped instead, and the caller must not make it ready
+static bool kernel_signals_let_run(task_t* task, const task_state_t from) {
+    if ((task->signals & TASK_SIGKILL) && task_can_die(task)) {
+        TRACE_EVENT(TRACE_STATE, TASK_DEAD, from, task->id, 0);
+        task->state = TASK_DEAD;
+        return false;
+    }
+
+    if (task->signals & TASK_SIGSTOP) {
+        TRACE_EVENT(TRACE_STATE, TASK_STOPPED, from, task->id, 0);
+        task->state = TASK_STOPPED;
+        return false;
+    }
+
+    return true;
+}
+
+// file a task that is not running into the queue matching its state, on the core that owns it
+void task_enqueue(task_t* task) {
+    if (task->state == TASK_READY && !kernel_signals_let_run(task, TASK_READY)) {
+        return;
+    }
+
+#if DEADLINE_SCHEDULING
+    if (task->state == TASK_READY && task_by_deadline(task)) {
+        task_heap_push(&schedulers[task->core].deadline_heap, task, task->deadline_us);
+        task->queue = TASK_QUEUE_DEADLINE;
+        return;
+    }
+#endif
+
+    if (task->state == TASK_READY) {
+        ready_queue_push(&schedulers[task->core].ready_queue, task);
+    }
+    else if (task->state == TASK_WAIT_US || (task->state == TASK_BLOCKED && !is_at_the_end_of_time(task->resume_us))) {
+        sleep_queue_insert(task); // blocked tasks with a timeout sleep until it, in case nobody wakes them first
+    }
+}
+
+// take a task out of whatever queue it is in
+void task_dequeue(task_t* task) {
+    if (task->queue == TASK_QUEUE_READY) {
+        ready_queue_remove(&schedulers[task->core].ready_queue, task);
+    }
+    else if (task->queue == TASK_QUEUE_SLEEP) {
+        sleep_queue_remove(task);
+    }
+#if DEADLINE_SCHEDULING
+    else if (task->queue == TASK_QUEUE_DEADLINE) {
+        task_heap_remove(&schedulers[task->core].deadline_heap, task);
+        task->queue = TASK_QUEUE_NONE;
+    }
+#endif
+}
+
+void task_set_state(task_t* task, const task_state_t state) {
+    task_dequeue(task);
+
+    // a task with a kill or stop pending goes there instead of becoming ready, and only that is traced
+    // (a running one is looked at as it is switched out)
+    if (state == TASK_READY && !task_is_running(task) && !kernel_signals_let_run(task, task->state)) {
+        return;
+    }
+
+    TRACE_EVENT(TRACE_STATE, state, task->state, task->id, 0);
+#if TRACE
+    if (state == TASK_READY && (task->state == TASK_BLOCKED || task->state == TASK_WAIT_US)) {
+        TRACE_EVENT(TRACE_WAKE, task->core, 0, task->id, current_task_id());
+    }
+#endif
+
+    task->state = state;
+
+    // running tasks are filed away by `get_next_task` when they are switched out
+    if (task_is_running(task)) {
+        return;
+    }
+
+    task_enqueue(task);
+
+    if (state == TASK_READY) {
+        preempt_for_task(task);
+    }
+}
+
+void task_set_priority(task_t* task, const uint8_t priority) {
+    const uint32_t saved_irq = task_lock(task);
+
+    if (task->priority == priority) {
+        task_unlock(task, saved_irq);
+        return;
+    }
+
+    const bool raised = priority > task->priority;
+
+    // the ready queue is kept by priority, so the task has to be taken out to move it
+    if (task->queue == TASK_QUEUE_READY) {
+        task_dequeue(task);
+        task->priority = priority;
+        task_enqueue(task);
+    }
+    else {
+        task->priority = priority;
+    }
+
+    if (raised && task->state == TASK_READY && !task_is_running(task)) {
+        preempt_for_task(task);
+    }
+    else if (!raised && task_is_running(task)) {
+        scheduler_reschedule_core(task->core); // something that was waiting may outrank it now
+    }
+
+    task_unlock(task, saved_irq);
+}
+
+// move every sleeping task on this core whose time has come back into the ready queue
+// sleepers come out of the heap earliest first, so this stops at the first one still sleeping
+void wake_sleeping_tasks(scheduler_t* scheduler, const absolute_time_t now) {
+    const uint64_t now_us = to_us_since_boot(now);
+
+    while (task_heap_peek_key(&scheduler->sleep_heap) <= now_us) {
+        // a blocked task that times out stays in its wait queue, `task_wait_finish` takes it out
+        task_t* task = task_heap_pop(&scheduler->sleep_heap);
+        task->queue = TASK_QUEUE_NONE;
+        TRACE_EVENT(TRACE_WAKE, task->core, 0, task->id, TRACE_NO_TASK);
+
+        if (kernel_signals_let_run(task, task->state)) {
+            task->state = TASK_READY;
+            task_enqueue(task);
+        }
+    }
+}
+
+// of the cores a task may run on, the one with the least ready work.
+// the task's affinity must allow at least one core
+uint8_t pick_core_for_task(const task_t* task) {
+    uint8_t best_core = CORE_COUNT;
+
+    for (uint8_t c = 0; c < CORE_COUNT; c++) {
+        if (!task_allowed_on_core(task, c)) {
+            continue;
+        }
+
+        if (best_core == CORE_COUNT || schedulers[c].ready_queue.count < schedulers[best_core].ready_queue.count) {
+            best_core = c;
+        }
+    }
+
+    return best_core;
+}
+
+#if CORE_COUNT > 1
+// take a ready task from another core that outranks `to_beat`, the best task this core has of its own.
+// an idle core takes anything, from whichever core has the most waiting,
+// otherwise it only takes a task that is stuck behind something more important on its own core.
+// tasks whose affinity doesn't allow this core (like the other core's idle task) are left alone.
+// only ever try-locks the other queue, so two cores stealing from each other can't deadlock
+task_t* steal_task(const uint8_t this_core, const task_t* to_beat) {
+#if DEADLINE_SCHEDULING
+    // nothing in a ready queue outranks a deadline task
+    if (to_beat != NULL && task_by_deadline(to_beat)) {
+        return NULL;
+    }
+#endif
+
+    const int32_t min_priority = (to_beat == NULL || is_idle_task(to_beat)) ? -1 : to_beat->priority;
+    uint8_t victim_core = this_core;
+    int32_t victim_priority = min_priority;
+    uint32_t victim_count = 1; // a queue holding only an idle task has nothing to give
+
+    for (uint8_t c = 0; c < CORE_COUNT; c++) {
+        const ready_queue_t* queue = &schedulers[c].ready_queue;
+
+        // looked at without the lock, it is only a hint
+        if (c == this_core || queue->count <= 1) {
+            continue;
+        }
+
+        const int32_t top_priority = ready_queue_top_priority(queue);
+        if (top_priority > victim_priority || (top_priority == victim_priority && queue->count > victim_count)) {
+            victim_core = c;
+            victim_priority = top_priority;
+            victim_count = queue->count;
+        }
+    }
+
+    if (victim_core == this_core) {
+        return NULL;
+    }
+
+    if (!run_queue_spin_try_lock_unsafe(victim_core)) {
+        return NULL; // the other core is busy with its queue, don't wait for it
+    }
+
+    ready_queue_t* victim_queue = &schedulers[victim_core].ready_queue;
+    task_t* task = ready_queue_peek_for_core(victim_queue, this_core, min_priority);
+
+    if (task != NULL) {
+        ready_queue_remove(victim_queue, task);
+        task->core = this_core;
+    }
+
+    run_queue_spin_unlock_unsafe(victim_core);
+    return task;
+}
+
+// move a task that may not run on this core over to a core it may run on.
+// this core's run queue is locked, so the other one is only try-locked
+bool hand_off_task(task_t* task) {
+    const uint8_t target_core = pick_core_for_task(task);
+
+    if (!run_queue_spin_try_lock_unsafe(target_core)) {
+        return false;
+    }
+
+    task->core = target_core;
+    task_enqueue(task);
+
+    run_queue_spin_unlock_unsafe(target_core);
+
+    if (task->state == TASK_READY) {
+        preempt_for_task(task);
+    }
+    return true;
+}
+#endif
+
+// put the task being switched out back into the queues,
+// handing it to another core if its affinity no longer allows this one
+void file_away_task(task_t* task) {
+#if CORE_COUNT > 1
+    if (!task_allowed_on_core(task, CORE_NUM) && hand_off_task(task)) {
+        return;
+    }
+#endif
+    task_enqueue(task);
+}
+
 void calculate_cpu_usage() {
     const uint32_t saved_irq = scheduler_spin_lock();
 
 #if CPU_FANCY_USAGE_MONITORING
     uint32_t total_us_executing = 0;
     uint32_t total_us_idling = 0;
+    uint32_t core_us_executing[CORE_COUNT];
 
     // calculate core usage
     for (uint8_t s = 0; s < CORE_COUNT; s++) {
@@ -67,6 +455,7 @@ void calculate_cpu_usage() {
 
         uint32_t us_executing = scheduler->us_executing;
         uint32_t us_idling = scheduler->us_idling;
+        core_us_executing[s] = us_executing;
 
         total_us_executing += us_executing;
         total_us_idling += us_idling;
@@ -92,10 +481,17 @@ void calculate_cpu_usage() {
 
         task->cpu_usage = (task->us_executing * 100) / total_us_executing;
         task->us_executing = 0;
+
+        // and how that time was split between the cores
+        for (uint8_t c = 0; c < CORE_COUNT; c++) {
+            task->core_usage[c] = core_us_executing[c] > 0 ? (task->us_executing_on[c] * 100) / core_us_executing[c] : 0;
+            task->us_executing_on[c] = 0;
+        }
     }
 #else
     uint32_t total_ticks_executing = 0;
     uint32_t total_ticks_idling = 0;
+    uint32_t core_ticks_executing[CORE_COUNT];
 
     // calculate core usage
     for (uint8_t s = 0; s < CORE_COUNT; s++) {
@@ -103,6 +499,7 @@ void calculate_cpu_usage() {
 
         uint32_t ticks_executing = scheduler->ticks_executing;
         uint32_t ticks_idling = scheduler->ticks_idling;
+        core_ticks_executing[s] = ticks_executing;
 
         total_ticks_executing += ticks_executing;
         total_ticks_idling += ticks_idling;
@@ -128,6 +525,12 @@ void calculate_cpu_usage() {
 
         task->cpu_usage = (task->ticks_executing * 100) / total_ticks_executing;
         task->ticks_executing = 0;
+
+        // and how that time was split between the cores
+        for (uint8_t c = 0; c < CORE_COUNT; c++) {
+            task->core_usage[c] = core_ticks_executing[c] > 0 ? (task->ticks_executing_on[c] * 100) / core_ticks_executing[c] : 0;
+            task->ticks_executing_on[c] = 0;
+        }
     }
 #endif
 
@@ -157,15 +560,12 @@ void heap_dump() {
         if (task->state == TASK_FREE) {
             continue;
         }
-        printf("(Task: %lu, Top: %p, Base: %p, SP: %p)", task->id, task->stack, task->stack_base, task->stack_pointer);
+        printf("(Task: %lu, Top: %p, Base: %p, SP: %p)", (unsigned long)task->id, task->stack, task->stack_base, task->stack_pointer);
     }
     printf(")\n");
 }
 
 uint32_t resize_stack(task_t* task, uint32_t new_size) {
-#if PROFILE_SCHEDULER
-    profile.ran_stack_resize = true;
-#endif
 #if DUMP_STACKS
     heap_dump();
 #endif
@@ -182,39 +582,51 @@ uint32_t resize_stack(task_t* task, uint32_t new_size) {
     uint32_t stack_pointer_offset = task->stack_base - task->stack_pointer;
     uint32_t old_size = task->stack_size;
 
-    uint32_t* reallocated_stack = NULL;
+    // stacks come in whole blocks, so small steps may land on the block it already has
+    if (stack_pool_block_words(new_size) == old_size) {
+        return old_size;
+    }
+
+    uint32_t block_size;
+    uint32_t* new_stack = task->stack;
 
-    if (new_size > old_size) {
-        reallocated_stack = realloc(task->stack, new_size * sizeof(uint32_t));
+    // everything on the stack sits at the end of its block, so if the block can grow down
+    // or give up its bottom in place, nothing has to be copied
+    const bool in_place = new_size > old_size ? stack_pool_grow(&new_stack, new_size, &block_size)
+                                              : stack_pool_shrink(&new_stack, new_size, &block_size);
 
-        if (reallocated_stack == NULL) {
+    if (in_place) {
+        task->stack = new_stack;
+        task->stack_size = block_size;
+        new_size = block_size;
+    }
+    else {
+        new_stack = stack_pool_alloc(new_size, &block_size);
+
+        if (new_stack == NULL) {
             return old_size; // if its null, that means there was no more room
         }
 
-        task->stack = reallocated_stack;
-        task->stack_size = new_size;
+        new_size = block_size;
 
-        const uint32_t additional_space = new_size - old_size;
+        // the stack grows down from the end, so it is kept against the end of the new block
+        if (new_size > old_size) {
+            const uint32_t additional_space = new_size - old_size;
 
-        memmove(&task->stack[additional_space], &task->stack[0], old_size * sizeof(uint32_t));
+            memcpy(&new_stack[additional_space], &task->stack[0], old_size * sizeof(uint32_t));
 
-        // fill the rest of the new stack with the filler
-        for (uint32_t i = 0; i < additional_space; i++) {
-            task->stack[i] = STACK_FILLER;
-        }
-    } else if (new_size < old_size) {
-        reallocated_stack = malloc(new_size * sizeof(uint32_t));
+            // fill the rest of the new stack with the filler
+            for (uint32_t i = 0; i < additional_space; i++) {
+                new_stack[i] = STACK_FILLER;
+            }
+        } else {
+            const uint32_t reduction = old_size - new_size;
 
-        if (reallocated_stack == NULL) {
-            return old_size; // if its null, that means there was no more room
+            memcpy(new_stack, &task->stack[reduction], new_size * sizeof(uint32_t));
         }
 
-        const uint32_t reduction = old_size - new_size;
-        
-        memmove(reallocated_stack, &task->stack[reduction], new_size * sizeof(uint32_t));
-
-        free(task->stack);
-        task->stack = reallocated_stack;
+        stack_pool_free(task->stack);
+        task->stack = new_stack;
         task->stack_size = new_size;
     }
 
@@ -224,6 +636,8 @@ uint32_t resize_stack(task_t* task, uint32_t new_size) {
     task->stack_hwm = 0;
 #endif
 
+    TRACE_EVENT(TRACE_STACK_RESIZE, 0, old_size, task->id, new_size);
+
 #if DUMP_STACKS
     heap_dump();
 #endif
@@ -235,92 +649,146 @@ uint32_t resize_stack(task_t* task, uint32_t new_size) {
 }
 
 bool find_and_flag_stack_overflow(task_t* task) {
+#if !STACK_GUARD_MPU // the guard catches overflows as they happen (and the check point is inside it)
     uint32_t* check_point = task->stack + STACK_OVERFLOW_THRESHOLD - 1;
 
     if (*check_point != STACK_FILLER) {
 #if DYNAMIC_STACK
-        task->state = TASK_STACK_OVERFLOWED;
+        task_set_state(task, TASK_STACK_OVERFLOWED);
 #else
-        task->state = TASK_SUSPENDED;
+        task_set_state(task, TASK_SUSPENDED);
 #endif
         return false;
     }
+#endif
 
     return true;
 }
 
-void calculate_stack_usage() {
-    const uint32_t saved_irq = scheduler_spin_lock();
-
-    for (uint32_t t = 0; t < MAX_TASKS; t++) {
-        task_t* task = &tasks[t];
-
-        if (task->state == TASK_FREE || task->state == TASK_RUNNING) {
-            continue;
-        }
-
+// where the stack usage scan got to, as it is spread over as many calls as it takes
+static struct {
+    uint32_t task;          // index into `tasks` of the task being scanned
+    uint32_t next_word;     // the word its scan carries on from
+    uint32_t unused;        // filler words found below `next_word`
+    uint32_t* stack;        // its stack when the scan started, if it moved since the scan starts over
+    bool started;           // the task's scan has been started
+} stack_scan;
+
+// the task's run queue must be locked, and the task must not be running
+// scans at most `*budget` words, taking off what it used, and returns whether the task is done with
+bool calculate_task_stack_usage(task_t* task, uint32_t* budget) {
+    if (!stack_scan.started || stack_scan.stack != task->stack) {
 #if OPTIMIZE_STACK_MONITORING
         if (task->state == TASK_SUSPENDED) {
-            continue;
+            return true;
         }
 
         if (task->stack_recalculate_cooldown > 0) {
             task->stack_recalculate_cooldown--;
-            continue;
+            return true;
         }
-#endif
 
-        uint32_t total_stack = task->stack_size;
-#if OPTIMIZE_STACK_MONITORING
-        uint32_t starting_index = task->stack_hwm;
+        stack_scan.next_word = task->stack_hwm;
 #else
-        uint32_t starting_index = 0;
+        stack_scan.next_word = 0;
 #endif
-        uint32_t stack_unused = starting_index;
+        stack_scan.unused = stack_scan.next_word;
+        stack_scan.stack = task->stack;
+        stack_scan.started = true;
+    }
 
-        for (uint32_t i = starting_index; i < total_stack; i++) {
-            // remember, the ARM stack grows downwards!
-            if (task->stack[i] == STACK_FILLER) {
-                stack_unused++;
-            }
-            else {
+    uint32_t total_stack = task->stack_size;
+    uint32_t i = stack_scan.next_word;
+    bool found_used = false;
+
+    for (; i < total_stack && *budget > 0; i++, (*budget)--) {
+        // remember, the ARM stack grows downwards!
+        if (task->stack[i] == STACK_FILLER) {
+            stack_scan.unused++;
+        }
+        else {
 #if OPTIMIZE_STACK_MONITORING
-                task->stack_hwm = i - 1;
+            task->stack_hwm = i - 1;
 #endif
-                break;  // we started from the side that will be touched last
-                        // so if this word was used so will all the rest
-            }
+            found_used = true;
+            break;  // we started from the side that will be touched last
+                    // so if this word was used so will all the rest
         }
+    }
+
+    // out of budget, carry on from here next time
+    if (!found_used && i < total_stack) {
+        stack_scan.next_word = i;
+        return false;
+    }
 
-        uint32_t stack_used = total_stack - stack_unused;
+    stack_scan.started = false;
 
-        task->stack_usage = (stack_used * 100) / total_stack;
+    uint32_t stack_unused = stack_scan.unused;
+    uint32_t stack_used = total_stack - stack_unused;
+
+    task->stack_usage = (stack_used * 100) / total_stack;
 
 #if OPTIMIZE_STACK_MONITORING
-        task->stack_recalculate_cooldown = OPTIMIZE_STACK_MONITORING_FACTOR * (stack_unused / STACK_OVERFLOW_THRESHOLD);
-        if (task->state == TASK_WAIT_US) {
-            task->stack_recalculate_cooldown++;
-        }
+    task->stack_recalculate_cooldown = OPTIMIZE_STACK_MONITORING_FACTOR * (stack_unused / STACK_OVERFLOW_THRESHOLD);
+    if (task->state == TASK_WAIT_US || task->state == TASK_BLOCKED) {
+        task->stack_recalculate_cooldown++;
+    }
 #endif
 
-        if (stack_unused < STACK_OVERFLOW_THRESHOLD) {
+    if (stack_unused < STACK_OVERFLOW_THRESHOLD) {
 #if DYNAMIC_STACK
-            if (task->stack_size < MAX_STACK_SIZE) {
-                resize_stack(task, task->stack_size + STACK_STEP_SIZE);
-            }
-            else {
-                task->state = TASK_SUSPENDED;
-            }
+        if (task->stack_size < MAX_STACK_SIZE) {
+            resize_stack(task, task->stack_size + STACK_STEP_SIZE);
+        }
+        else {
+            task_set_state(task, TASK_SUSPENDED);
+        }
 #else
-            task->state = TASK_SUSPENDED;
+        task_set_state(task, TASK_SUSPENDED);
 #endif
+    }
+
+    return true;
+}
+
+void calculate_stack_usage() {
+    const uint32_t saved_irq = scheduler_spin_lock();
+
+    uint32_t budget = STACK_MONITOR_BUDGET;
+
+    // every task is looked at once at most, so a call ends even when there is nothing to scan
+    for (uint32_t visited = 0; visited < MAX_TASKS && budget > 0; visited++) {
+        task_t* task = &tasks[stack_scan.task];
+        bool done = true;
+
+        // a dead task's stack is about to be collected, and finding it deep would suspend it instead
+        if (task->state != TASK_FREE && task->state != TASK_DEAD) {
+            // lock the task's run queue, so another core can't start running it while we look at its stack
+            const uint32_t task_irq = task_lock(task);
+
+            // a task that started running meanwhile gets scanned next time around
+            if (!task_is_running(task)) {
+                done = calculate_task_stack_usage(task, &budget);
+            }
+
+            task_unlock(task, task_irq);
         }
+
+        if (!done) {
+            break;
+        }
+
+        stack_scan.started = false;
+        stack_scan.task = (stack_scan.task + 1) % MAX_TASKS;
     }
 
     scheduler_spin_unlock(saved_irq);
 }
 
 void scheduler_garbage_collect() {
+    const uint32_t saved_irq = scheduler_spin_lock();
+
     for (uint32_t t = 0; t < MAX_TASKS; t++) {
         task_t* task = &tasks[t];
 
@@ -331,12 +799,14 @@ void scheduler_garbage_collect() {
 
         // if task is dead, remove it
         if (task->state == TASK_DEAD) {
-            free(task->stack);
+            stack_pool_free(task->stack);
             task->state = TASK_FREE;
             num_tasks--;
             continue;
         }
 
+        const uint32_t task_irq = task_lock(task);
+
         // if the stack wants more memory, allocate more
         if (task->state == TASK_STACK_OVERFLOWED) {
 #if DYNAMIC_STACK
@@ -347,104 +817,197 @@ void scheduler_garbage_collect() {
                     desired_size = task->requested_stack_size;
                     task->requested_stack_size = 0;
                 }
-                uint32_t old_size = task->stack_size;
                 uint32_t new_size = resize_stack(task, desired_size);
-                if (new_size == desired_size) {
-                    task->state = TASK_READY;
+                if (new_size >= desired_size) {
+                    task_set_state(task, TASK_READY);
                 } else {
-                    task->state = TASK_SUSPENDED;
+                    task_set_state(task, TASK_SUSPENDED);
                 }
             } else {
-                task->state = TASK_SUSPENDED;
+                task_set_state(task, TASK_SUSPENDED);
             }
 #else
-            task->state = TASK_SUSPENDED;
+            task_set_state(task, TASK_SUSPENDED);
 #endif
         }
+
+        task_unlock(task, task_irq);
     }
+
+    scheduler_spin_unlock(saved_irq);
 }
 
-// TODO: optimize by making it so it only has to loop through existing tasks, not all possible tasks
-__attribute__((noinline))
-void get_next_task() {
+// whether a task just taken out of this core's queues can run here now,
+// if not it is handed to a core it may run on (or kept in `passed_over` to try again),
+// or it is flagged for outgrowing its stack
+static bool can_run_here(task_t* task, task_t** passed_over) {
+#if CORE_COUNT > 1
+    if (!task_allowed_on_core(task, CORE_NUM)) {
+        if (!hand_off_task(task)) {
+            task->queue_next = *passed_over; // out of the queue, so the link is free to borrow
+            *passed_over = task;
+        }
+        return false;
+    }
+#endif
+
+    return find_and_flag_stack_overflow(task);
+}
+
+#if DEADLINE_SCHEDULING
+// count a deadline task's run against its budget, it drops to its priority once the budget is gone
+static void charge_deadline_task(task_t* task, const uint32_t us) {
+    task->budget_used_us += us;
 
-#if PRINT
-    uint32_t start_time = time_us_32();
+    if (task->budget_us != 0 && !task->throttled && task->budget_used_us >= task->budget_us) {
+        task->throttled = true;
+        task->deadline_stats.budget_overruns++;
+    }
+}
 #endif
 
+__attribute__((noinline))
+void get_next_task() {
     scheduler_t* scheduler = get_scheduler();
     task_t* current_task = scheduler->current_task;
+    bool yielding = false;
+#if TRACE
+    const task_state_t switched_out_state = current_task != NULL ? current_task->state : TASK_FREE;
+#endif
+
+    // the very first call on a core has no task to switch out
+    if (current_task != NULL) {
 #if CPU_FANCY_USAGE_MONITORING
-    uint32_t time_passed = time_us_32() - scheduler->loop_start_us;
-    current_task->us_executing += time_passed;
-    scheduler->us_executing += time_passed;
-    if (current_task->id < CORE_COUNT) {
-        scheduler->us_idling += time_passed;
-    }
+        uint32_t time_passed = time_us_32() - scheduler->loop_start_us;
+        current_task->us_executing += time_passed;
+        current_task->us_executing_on[CORE_NUM] += time_passed;
+        scheduler->us_executing += time_passed;
+        if (current_task->id < CORE_COUNT) {
+            scheduler->us_idling += time_passed;
+        }
+#endif
+#if DEADLINE_SCHEDULING
+        if (current_task->period_us != 0) {
+            charge_deadline_task(current_task, time_us_32() - scheduler->run_start_us);
+        }
 #endif
 
-    int16_t highest_priority = -1;
+#if STACK_GUARD_MPU
+        // it ran into its guard, so it waits for the garbage collector to give it more stack
+        // (a task that was on its way out anyway finds the guard again when it comes back)
+        if (scheduler->stack_guard_hit) {
+            scheduler->stack_guard_hit = false;
 
-    if (current_task->state == TASK_RUNNING) {
-        current_task->state = TASK_READY; // tell scheduler that the old task is not running anymore
-        // when we move to dual-core, this will be useful
-    }
+            if (current_task->state == TASK_RUNNING || current_task->state == TASK_YIELDING) {
+#if DYNAMIC_STACK
+                task_set_state(current_task, TASK_STACK_OVERFLOWED);
+#else
+                task_set_state(current_task, TASK_SUSPENDED);
+#endif
+            }
+        }
+#endif
 
-    if (current_task->state == TASK_ZOMBIE) {
-        current_task->state = TASK_DEAD;
+        if (current_task->state == TASK_RUNNING) {
+            if (kernel_signals_let_run(current_task, TASK_RUNNING)) {
+                current_task->state = TASK_READY; // tell scheduler that the old task is not running anymore
+                file_away_task(current_task);     // it goes to the back of its priority level (round-robin)
+            }
+        }
+        else if (current_task->state == TASK_YIELDING) {
+            // a yielding task is put back only after the next task is chosen,
+            // as if a high priority task yields we want to run a lower priority task before running it again
+            yielding = true;
+        }
+        else if (current_task->state == TASK_ZOMBIE) {
+            current_task->state = TASK_DEAD;
+        }
+        else {
+            file_away_task(current_task); // sleeping tasks go to the sleep heap, the rest go nowhere
+        }
     }
 
-    uint32_t potential_index = scheduler->current_task_index;
-    absolute_time_t now = get_absolute_time();
+    wake_sleeping_tasks(scheduler, get_absolute_time());
 
-    for (uint32_t t = 0; t < MAX_TASKS; t++) {
-        potential_index++;
+    task_t* next_task = NULL;
+    task_t* passed_over = NULL; // tasks that may not run here, but couldn't be handed off yet
 
-        if (potential_index >= MAX_TASKS) {
-            potential_index = 0;
+#if DEADLINE_SCHEDULING
+    // deadline tasks go ahead of every priority task, earliest deadline first
+    while (next_task == NULL && (next_task = task_heap_pop(&scheduler->deadline_heap)) != NULL) {
+        next_task->queue = TASK_QUEUE_NONE;
+        if (!can_run_here(next_task, &passed_over)) {
+            next_task = NULL;
         }
+    }
+#endif
 
-        task_t* potential_task = &tasks[potential_index];
-
-        // if this task is not usable, skip
-        if (potential_task->state == TASK_FREE ||
-            potential_task->state == TASK_DEAD ||
-            potential_task->state == TASK_STACK_OVERFLOWED ||
-            potential_task->state == TASK_SUSPENDED) {
-            continue;
+    while (next_task == NULL && (next_task = ready_queue_pop(&scheduler->ready_queue)) != NULL) {
+        if (!can_run_here(next_task, &passed_over)) {
+            next_task = NULL;
         }
+    }
 
-        // see if the required time has passed for this task, if it was waiting
-        if (potential_task->state == TASK_WAIT_US) {
-            if (absolute_time_diff_us(now, potential_task->resume_us) <= 0) {
-                potential_task->state = TASK_READY;
-            }
-        }
+#if CORE_COUNT > 1
+    // try those again next time
+    while (passed_over != NULL) {
+        task_t* task = passed_over;
+        passed_over = task->queue_next;
+        task_enqueue(task);
+    }
+#endif
 
-        // if this task has the highest priority found so far, select it
-        if ((potential_task->state == TASK_READY) && (potential_task->priority > highest_priority)) {
-            if (find_and_flag_stack_overflow(potential_task)) {
-                highest_priority = potential_task->priority;
-                scheduler->current_task_index = potential_index;
-                scheduler->current_task = potential_task;
-            }
+#if CORE_COUNT > 1
+    // see if another core has work to spare, or something more important than ours stuck waiting
+    task_t* stolen_task = steal_task(CORE_NUM, next_task);
+
+    if (stolen_task != NULL && find_and_flag_stack_overflow(stolen_task)) {
+        if (next_task != NULL) {
+            ready_queue_push(&scheduler->ready_queue, next_task); // put ours back
         }
+        next_task = stolen_task;
+    }
+#endif
 
-        // if this task was yielding, reset it to ready
-        // this is done after the task is chosen, as if a high priority task yields
-        // we want to run a lower priority task before running the high priority one again
-        if (potential_task->state == TASK_YIELDING) {
-            potential_task->state = TASK_READY;
+    if (yielding && kernel_signals_let_run(current_task, TASK_YIELDING)) {
+        current_task->state = TASK_READY;
+
+        if (next_task != NULL) {
+            file_away_task(current_task);
+        }
+        else {
+            next_task = current_task; // nothing else wants to run
         }
     }
-#if PRINT
-    printf("\ntime: %lu\n", time_us_32() - start_time);
-    printf("Loading task id: %lu\n", scheduler->current_task->id);
+
+    // the idle tasks make sure there is always something to run, but just in case
+    if (next_task == NULL) {
+        next_task = current_task;
+    }
+
+#if TRACE
+    if (next_task != current_task) {
+        TRACE_EVENT(TRACE_SWITCH, switched_out_state, 0, current_task != NULL ? current_task->id : TRACE_NO_TASK,
+                    next_task->id);
+    }
 #endif
+
+    scheduler->current_task = next_task;
     scheduler->current_task->state = TASK_RUNNING; // tell scheduler that the new task is running
+#if STACK_GUARD_MPU
+    stack_guard_set(next_task->stack);
+#endif
+#if TICKLESS_IDLE
+    if (scheduler->started) {
+        update_tick_mode(next_task);
+    }
+#endif
 #if CPU_FANCY_USAGE_MONITORING
     scheduler->loop_start_us = time_us_32();
 #endif
+#if DEADLINE_SCHEDULING
+    scheduler->run_start_us = time_us_32();
+#endif
 }
 
 // Called from the HardFault_Handler trampoline in context.s with a pointer to the
@@ -473,6 +1036,21 @@ void hard_fault_handler_c(uint32_t* fault_stack) {
     const uint32_t pc  = fault_stack[6];
     const uint32_t psr = fault_stack[7];
 
+#if STACK_GUARD_MPU
+    // a task that ran into its guard is switched out as soon as this returns, and tries the instruction
+    // again once it has more stack (the guard is lifted so the switch can still push onto it)
+    if (scheduler_is_started()) {
+        scheduler_t* scheduler = get_scheduler();
+
+        if (scheduler->current_task != NULL && stack_guard_hit(scheduler->current_task->stack, fault_stack)) {
+            stack_guard_clear();
+            scheduler->stack_guard_hit = true;
+            scheduler_raise_pendsv();
+            return;
+        }
+    }
+#endif
+
     uint32_t task_id = 0xFFFFFFFF;
     void* task_stack_base = NULL;
     void* task_stack_top = NULL;
@@ -486,12 +1064,13 @@ void hard_fault_handler_c(uint32_t* fault_stack) {
     }
 
     printf("\n\n!!! HARD FAULT on core %u !!!\n", CORE_NUM);
-    printf("  Running task id: %lu\n", task_id);
-    printf("  PC : 0x%08lx  <-- faulting instruction (use addr2line on this)\n", pc);
-    printf("  LR : 0x%08lx  <-- caller of the faulting function\n", lr);
-    printf("  PSR: 0x%08lx\n", psr);
-    printf("  R0 : 0x%08lx   R1 : 0x%08lx   R2 : 0x%08lx   R3 : 0x%08lx\n", r0, r1, r2, r3);
-    printf("  R12: 0x%08lx\n", r12);
+    printf("  Running task id: %lu\n", (unsigned long)task_id);
+    printf("  PC : 0x%08lx  <-- faulting instruction (use addr2line on this)\n", (unsigned long)pc);
+    printf("  LR : 0x%08lx  <-- caller of the faulting function\n", (unsigned long)lr);
+    printf("  PSR: 0x%08lx\n", (unsigned long)psr);
+    printf("  R0 : 0x%08lx   R1 : 0x%08lx   R2 : 0x%08lx   R3 : 0x%08lx\n", (unsigned long)r0, (unsigned long)r1,
+           (unsigned long)r2, (unsigned long)r3);
+    printf("  R12: 0x%08lx\n", (unsigned long)r12);
     if (task_stack_base) {
         printf("  Task stack: top=%p base=%p faulted_sp=%p\n",
                task_stack_top, task_stack_base, (void*)fault_stack);
@@ -515,122 +1094,258 @@ void hard_fault_handler_c(uint32_t* fault_stack) {
 }
 
 
-void refresh_systick_on_clock_change() {
-    const uint32_t clock_hz = clock_get_hz(clk_sys);
-    const uint32_t ticks = (clock_hz * LOOP_TIME) / 1000;
+void refresh_systick_on_clock_change() {
+    const uint32_t clock_hz = clock_get_hz(clk_sys);
+    const uint32_t ticks = (clock_hz * LOOP_TIME) / 1000;
+
+#if TICKLESS_IDLE
+    // a long sleep counted at the old speed would go off at the wrong time,
+    // so a core idling without ticks takes them up again, and works out its sleep anew on the next switch
+    get_scheduler()->tickless = false;
+#endif
+
+    // set when the timer should fire based on new clock speed
+    systick_hw->rvr = ticks - 1;
+
+    // reset systick to zero
+    systick_hw->cvr = 0;
+}
+
+#if TICKLESS_IDLE
+// make this core's SysTick fire once after `us` microseconds (as far as 24 bits of ticks reach)
+void program_systick_us(const uint64_t us) {
+    const uint32_t clock_hz = clock_get_hz(clk_sys);
+    uint64_t ticks = ((uint64_t)clock_hz * us) / 1000000;
+
+    if (ticks > SYSTICK_MAX_TICKS) {
+        ticks = SYSTICK_MAX_TICKS;
+    }
+
+    if (ticks < 2) {
+        ticks = 2;
+    }
+
+    systick_hw->rvr = ticks - 1;
+    systick_hw->cvr = 0;
+}
+
+// if this core is about to idle with nothing else ready,
+// stop the periodic tick and sleep straight through to the earliest sleeper
+void update_tick_mode(const task_t* next_task) {
+    scheduler_t* scheduler = get_scheduler();
+
+    if (is_idle_task(next_task) && scheduler->ready_queue.count == 0) {
+        const uint64_t now_us = time_us_64();
+        const uint64_t wake_us = task_heap_peek_key(&scheduler->sleep_heap);
+        const uint64_t idle_us = (wake_us > now_us) ? wake_us - now_us : 0;
+
+        // only worth it if at least one tick gets skipped
+        if (idle_us > 2 * LOOP_TIME_US) {
+            program_systick_us(idle_us);
+            scheduler->tickless = true;
+            return;
+        }
+    }
+
+    if (scheduler->tickless) {
+        scheduler->tickless = false;
+        refresh_systick_on_clock_change();
+    }
+}
+#endif
+
+// whether a multiple of `period` is among the `count` ticks starting at `first_tick`
+static inline bool tick_period_due(const uint64_t first_tick, const uint32_t count, const uint32_t period) {
+    return (first_tick % period) == 0 || ((first_tick + count - 1) / period) != (first_tick / period);
+}
+
+#if CORE_COUNT > 1
+void handle_multicore_signal(const uint32_t cmd) {
+    if (cmd == MULTICORE_SIG_UPDATE_SYSTICK) {
+        refresh_systick_on_clock_change();
+        // acknowledge
+        multicore_fifo_push_blocking(MULTICORE_SIG_ACKNOWLEDGE);
+    }
+    else if (cmd == MULTICORE_SIG_ACKNOWLEDGE) {
+        get_scheduler()->signal_acknowledged = true;
+    }
+    else if (cmd == MULTICORE_SIG_RESCHEDULE) {
+        scheduler_raise_pendsv(); // no acknowledgement, the other core doesn't wait for us
+    }
+}
+
+// handles everything waiting in this core's FIFO
+// runs as the FIFO interrupt, so a core that is idling without ticks still answers straight away
+void check_multicore_signals() {
+    const uint32_t saved_irq = save_and_disable_interrupts();
+
+    while (multicore_fifo_rvalid()) {
+        handle_multicore_signal(multicore_fifo_pop_blocking());
+    }
 
-    // set when the timer should fire based on new clock speed
-    systick_hw->rvr = ticks - 1;
+    multicore_fifo_clear_irq();
+    restore_interrupts(saved_irq);
+}
 
-    // reset systick to zero
-    systick_hw->cvr = 0;
+void start_multicore_signals() {
+    const uint irq_num = SIO_IRQ_PROC0 + CORE_NUM;
+
+    multicore_fifo_clear_irq();
+    irq_set_exclusive_handler(irq_num, check_multicore_signals);
+    irq_set_priority(irq_num, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled(irq_num, true);
 }
+#endif
 
 void refresh_systick_all_cores() {
     // update the systick on this core
     refresh_systick_on_clock_change();
 
 #if CORE_COUNT > 1
+    scheduler_t* scheduler = get_scheduler();
+    scheduler->signal_acknowledged = false;
+
     // signal the other core to do the same
     multicore_fifo_push_blocking(MULTICORE_SIG_UPDATE_SYSTICK);
 
     // wait for a response from the other core
-    multicore_fifo_pop_blocking();
+    // (poll the FIFO ourselves, our FIFO interrupt can't preempt the SysTick handler)
+    while (!scheduler->signal_acknowledged) {
+        check_multicore_signals();
+    }
 #endif
 }
 
-#if CORE_COUNT > 1
-void check_multicore_signals() {
-    if (multicore_fifo_rvalid()) {
-        uint32_t cmd = multicore_fifo_pop_blocking();
+void scheduler_raise_pendsv() {
+    (*(volatile uint32_t *)(PPB_BASE + M0PLUS_ICSR_OFFSET)) |= M0PLUS_ICSR_PENDSVSET_BITS;
+}
 
-        if (cmd == MULTICORE_SIG_UPDATE_SYSTICK) {
-            refresh_systick_on_clock_change();
-            // acknowledge
-            multicore_fifo_push_blocking(MULTICORE_SIG_ACKNOWLEDGE);
-        }
+// housekeeping jobs (TRACE_HOUSEKEEPING_*) the tick found due, for the kernel worker to run
+static volatile uint8_t housekeeping_due = 0;
+static task_t* kernel_worker = NULL;
+
+// hand due jobs to the kernel worker, waking it if it is waiting for some
+static void kernel_worker_wake(const uint8_t jobs) {
+    housekeeping_due |= jobs;
+
+    // it hasn't run yet, it finds the jobs when it does
+    if (kernel_worker == NULL) {
+        return;
     }
-}
-#endif
 
-void scheduler_raise_pendsv() {
-    (*(volatile uint32_t *)(PPB_BASE + M0PLUS_ICSR_OFFSET)) |= M0PLUS_ICSR_PENDSVSET_BITS;
+    const uint32_t task_irq = task_lock(kernel_worker);
+    if (kernel_worker->state == TASK_BLOCKED) {
+        task_set_state(kernel_worker, TASK_READY);
+    }
+    task_unlock(kernel_worker, task_irq);
 }
 
 __attribute__((noinline))
-void SysTick_Handler(void) {
-#if PROFILE_SCHEDULER
-    profile.ran_channel_collection = false;
-    profile.ran_schedular_collection = false;
-    profile.ran_cpu_usage = false;
-    profile.ran_governor = false;
-    profile.ran_stack_resize = false;
-    profile.ran_stack_usage = false;
+void kernel_worker_task(uint32_t pid, uint32_t* signals, char* args) {
+    task_t* self = get_current_task();
+    kernel_worker = self;
+
+    while (true) {
+        // take whatever is due, or wait for the tick to hand something over
+        const uint32_t task_irq = task_lock(self);
+        const uint8_t jobs = housekeeping_due;
+        housekeeping_due = 0;
+
+        if (jobs == 0) {
+            self->resume_us = at_the_end_of_time;
+            task_set_state(self, TASK_BLOCKED);
+        }
+        task_unlock(self, task_irq);
+
+        if (jobs == 0) {
+            scheduler_raise_pendsv();
+            continue;
+        }
 
-    profile.start_us = time_us_64();
+#if TRACE
+        const uint32_t housekeeping_start_us = time_us_32();
 #endif
 
-#if CORE_COUNT > 1
-    // read and handle signals from other core
-    check_multicore_signals();
+        if (jobs & TRACE_HOUSEKEEPING_STACK_USAGE) {
+            calculate_stack_usage();
+        }
+        if (jobs & TRACE_HOUSEKEEPING_CHANNELS) {
+            channel_garbage_collect();
+        }
+        if (jobs & TRACE_HOUSEKEEPING_CPU_USAGE) {
+            calculate_cpu_usage();
+        }
+        if (jobs & TRACE_HOUSEKEEPING_TASKS) {
+            scheduler_garbage_collect();
+        }
+#if USE_GOVERNOR
+        if (jobs & TRACE_HOUSEKEEPING_GOVERNOR) {
+            governor_update();
+        }
 #endif
 
+        TRACE_EVENT(TRACE_HOUSEKEEPING, jobs, 0, time_us_32() - housekeeping_start_us, 0);
+    }
+}
+
+__attribute__((noinline))
+void SysTick_Handler(void) {
     scheduler_t* scheduler = get_scheduler();
+
+    // work out how many ticks really passed,
+    // as a core idling without ticks only gets here when its sleep is over
+    const uint64_t now_us = time_us_64();
+    uint32_t elapsed_ticks = (uint32_t)((now_us - scheduler->last_tick_us + (LOOP_TIME_US / 2)) / LOOP_TIME_US);
+    if (elapsed_ticks == 0) {
+        elapsed_ticks = 1;
+    }
+    scheduler->last_tick_us = now_us;
+
+    const uint64_t first_tick = scheduler->ticks_since_start;
+
 #if !CPU_FANCY_USAGE_MONITORING
-    scheduler->ticks_executing++;
+    scheduler->ticks_executing += elapsed_ticks;
     task_t* task = get_current_task();
 
     if (task->id < CORE_COUNT) {
-        scheduler->ticks_idling++;
+        scheduler->ticks_idling += elapsed_ticks;
     }
 
-    task->ticks_executing++;
+    task->ticks_executing += elapsed_ticks;
+    task->ticks_executing_on[CORE_NUM] += elapsed_ticks;
 #endif
 
+    // housekeeping is due if its period came up during any of the elapsed ticks,
+    // the kernel worker runs it so the tick itself stays short
     if (CORE_NUM == 0) {
-        if ((scheduler->ticks_since_start % STACK_MONITOR_PERIOD) == 0) {
-#if PROFILE_SCHEDULER
-            profile.ran_stack_usage = true;
-#endif
-            calculate_stack_usage();
+        uint8_t jobs = 0;
+
+#if STACK_MONITOR_PERIOD > 0
+        if (tick_period_due(first_tick, elapsed_ticks, STACK_MONITOR_PERIOD)) {
+            jobs |= TRACE_HOUSEKEEPING_STACK_USAGE;
         }
-        if ((scheduler->ticks_since_start % CHANNEL_GARBAGE_COLLECT_PERIOD) == 0) {
-#if PROFILE_SCHEDULER
-            profile.ran_channel_collection = true;
 #endif
-            channel_garbage_collect();
+        if (tick_period_due(first_tick, elapsed_ticks, CHANNEL_GARBAGE_COLLECT_PERIOD)) {
+            jobs |= TRACE_HOUSEKEEPING_CHANNELS;
         }
-        if ((scheduler->ticks_since_start % CPU_USAGE_PERIOD) == 0) {
-#if PROFILE_SCHEDULER
-            profile.ran_cpu_usage = true;
-#endif
-            calculate_cpu_usage();
+        if (tick_period_due(first_tick, elapsed_ticks, CPU_USAGE_PERIOD)) {
+            jobs |= TRACE_HOUSEKEEPING_CPU_USAGE;
         }
-        if ((scheduler->ticks_since_start % SCHEDULER_GARBAGE_COLLECT_PERIOD) == 0) {
-#if PROFILE_SCHEDULER
-            profile.ran_schedular_collection = true;
-#endif
-            scheduler_garbage_collect();
+        if (tick_period_due(first_tick, elapsed_ticks, SCHEDULER_GARBAGE_COLLECT_PERIOD)) {
+            jobs |= TRACE_HOUSEKEEPING_TASKS;
         }
 #if USE_GOVERNOR
-        if ((scheduler->ticks_since_start % GOVERNOR_PERIOD) == 0) {
-#if PROFILE_SCHEDULER
-            profile.ran_governor = true;
-#endif
-            governor_update();
+        if (tick_period_due(first_tick, elapsed_ticks, GOVERNOR_PERIOD)) {
+            jobs |= TRACE_HOUSEKEEPING_GOVERNOR;
         }
 #endif
-    }
-
-#if PROFILE_SCHEDULER
-    profile.end_us = time_us_64();
 
-    printf("\ntime: %llu, su: %u, sr: %u, sc: %u, cc: %u, cu: %u, cg: %u\n", profile.end_us - profile.start_us,
-           profile.ran_stack_usage, profile.ran_stack_resize, profile.ran_schedular_collection,
-           profile.ran_channel_collection, profile.ran_cpu_usage, profile.ran_governor);
-#endif
+        if (jobs != 0) {
+            kernel_worker_wake(jobs);
+        }
+    }
 
-    scheduler->ticks_since_start++;
+    scheduler->ticks_since_start += elapsed_ticks;
 
     // raise PendSV interrupt (handler in assembly!)
     scheduler_raise_pendsv();
@@ -654,13 +1369,15 @@ void remove_task(task_t* task) {
 
     // we make it a zombie until it stops running to prevent from freeing
     // the stack from another core while it is still running
-    if (task->state == TASK_RUNNING) {
+    const uint32_t task_irq = task_lock(task);
+    if (task_is_running(task)) {
         task->state = TASK_ZOMBIE;
     }
     else {
-        task->state = TASK_DEAD;
+        task_set_state(task, TASK_DEAD);
         num_tasks--;
     }
+    task_unlock(task, task_irq);
     scheduler_spin_unlock(saved_irq);
 
     scheduler_raise_pendsv();
@@ -672,8 +1389,15 @@ void task_return() {
 }
 
 __attribute__((noinline))
-kelp_error_t task_add_args(void (*task_function)(uint32_t, uint32_t*, char*), const uint32_t id, char* args,
-                      const uint8_t priority) {
+// the deadline arguments are all 0 for a priority task
+static kelp_error_t add_task(void (*task_function)(uint32_t, uint32_t*, char*), const uint32_t id, char* args,
+                             const uint8_t priority, const uint8_t core_mask, const uint32_t period_us,
+                             const uint32_t budget_us, const uint32_t deadline_us) {
+    if ((core_mask & TASK_ALL_CORES) == 0) {
+        PRINT_WARNING("Task may not run on any core.\n");
+        return KELP_NOT_SUPPORTED; // none of the cores in the mask exist
+    }
+
     // Acquire lock for initial checks
     const uint32_t saved_irq = scheduler_spin_lock();
 
@@ -716,31 +1440,57 @@ kelp_error_t task_add_args(void (*task_function)(uint32_t, uint32_t*, char*), co
 #else
     task->ticks_executing = 0;
 #endif
+    for (uint8_t c = 0; c < CORE_COUNT; c++) {
+#if CPU_FANCY_USAGE_MONITORING
+        task->us_executing_on[c] = 0;
+#else
+        task->ticks_executing_on[c] = 0;
+#endif
+        task->core_usage[c] = 0;
+    }
 #if OPTIMIZE_STACK_MONITORING
     task->stack_recalculate_cooldown = 0;
 #endif
     task->id = id;
     task->priority = priority;
+    task->base_priority = priority;
+    task->held_mutexes = NULL;
+    task->signals = 0;
+    task->signal_mask = 0;
+    task->blocked_on = NULL;
+    task->affinity = core_mask & TASK_ALL_CORES;
+    task->overruns = 0;
+#if DEADLINE_SCHEDULING
+    task->period_us = period_us;
+    task->budget_us = budget_us;
+    task->relative_deadline_us = deadline_us;
+    task->release_us = time_us_64();
+    task->deadline_us = task->release_us + deadline_us;
+    task->budget_used_us = 0;
+    task->throttled = false;
+    memset(&task->deadline_stats, 0, sizeof(task->deadline_stats));
+#endif
 
 #if DYNAMIC_STACK
     const uint32_t stack_size = STARTING_STACK_SIZE;
 #else
     const uint32_t stack_size = STACK_SIZE;
 #endif
-    task->stack = (uint32_t*)malloc(stack_size * sizeof(uint32_t)); // dynamically get stack from heap
+    uint32_t block_size;
+    task->stack = stack_pool_alloc(stack_size, &block_size); // from the stack pool, or the heap without it
 
     if (task->stack == NULL) {
         return KELP_MEMORY;
     }
 
-    task->stack_size = stack_size; // in 32bit words
+    task->stack_size = block_size; // in 32bit words
     task->stack_base = task->stack + task->stack_size - 1; // highest value in stack (where the sp starts)
 #if OPTIMIZE_STACK_MONITORING
     task->stack_hwm = 0;
 #endif
 
     // fill stack with known values for stack monitoring
-    for (uint32_t i = 0; i < stack_size; i++) {
+    for (uint32_t i = 0; i < task->stack_size; i++) {
         task->stack[i] = STACK_FILLER;
     }
 
@@ -761,12 +1511,12 @@ kelp_error_t task_add_args(void (*task_function)(uint32_t, uint32_t*, char*), co
 
     // set up initial stack frame for context switching
     *(task->stack_pointer--) = (uint32_t)0x01000000; // PSR (Thumb bit set)
-    *(task->stack_pointer--) = (uint32_t)task_function; // PC (where to start)
-    *(task->stack_pointer--) = (uint32_t)task_return; // LR (return address)
+    *(task->stack_pointer--) = (uint32_t)(uintptr_t)task_function; // PC (where to start)
+    *(task->stack_pointer--) = (uint32_t)(uintptr_t)task_return; // LR (return address)
     *(task->stack_pointer--) = 12; // R12
     *(task->stack_pointer--) = args_size; // R3
-    *(task->stack_pointer--) = (uint32_t)args_in_stack; // R2 (pointer to args)
-    *(task->stack_pointer--) = (uint32_t)&task->signals; // R1 (pass signals to task)
+    *(task->stack_pointer--) = (uint32_t)(uintptr_t)args_in_stack; // R2 (pointer to args)
+    *(task->stack_pointer--) = (uint32_t)(uintptr_t)&task->signals; // R1 (pass signals to task)
     *(task->stack_pointer--) = task->id; // R0 (pass id to task)
 
     // I'm leaving these here as a testimony of frustration
@@ -786,12 +1536,64 @@ kelp_error_t task_add_args(void (*task_function)(uint32_t, uint32_t*, char*), co
     *(task->stack_pointer--) = 9; // R9
     *(task->stack_pointer) = 8; // R8
 
-    task->state = TASK_READY;
+    task->queue = TASK_QUEUE_NONE;
 
+    const uint32_t saved_irq_ready = scheduler_spin_lock();
+    task->core = pick_core_for_task(task);
+    const uint32_t task_irq = task_lock(task);
+    task_set_state(task, TASK_READY);
+    task_unlock(task, task_irq);
     num_tasks++;
+    scheduler_spin_unlock(saved_irq_ready);
+
     return KELP_OK;
 }
 
+// ids from KERNEL_PID_BASE up are only for the tasks `kernel_start` adds, so they can't be taken first
+static inline bool is_reserved_pid(const uint32_t id) {
+    if (id >= KERNEL_PID_BASE) {
+        PRINT_WARNING("Task id is reserved for the kernel.\n");
+        return true;
+    }
+
+    return false;
+}
+
+kelp_error_t task_add_args_affinity(void (*task_function)(uint32_t, uint32_t*, char*), const uint32_t id, char* args,
+                                    const uint8_t priority, const uint8_t core_mask) {
+    if (is_reserved_pid(id)) {
+        return KELP_ID_TAKEN;
+    }
+
+    return add_task(task_function, id, args, priority, core_mask, 0, 0, 0);
+}
+
+#if DEADLINE_SCHEDULING
+kelp_error_t task_add_deadline(void (*task_function)(uint32_t, uint32_t*, char*), const uint32_t id,
+                               const uint32_t period_us, const uint32_t budget_us, const uint32_t deadline_us,
+                               const uint8_t priority, const uint8_t core) {
+    if (core >= CORE_COUNT || period_us == 0 || deadline_us == 0 || budget_us > deadline_us) {
+        return KELP_NOT_SUPPORTED;
+    }
+
+    if (is_reserved_pid(id)) {
+        return KELP_ID_TAKEN;
+    }
+
+    return add_task(task_function, id, "\0", priority, TASK_CORE(core), period_us, budget_us, deadline_us);
+}
+#endif
+
+kelp_error_t task_add_args(void (*task_function)(uint32_t, uint32_t*, char*), const uint32_t id, char* args,
+                      const uint8_t priority) {
+    return task_add_args_affinity(task_function, id, args, priority, TASK_ANY_CORE);
+}
+
+kelp_error_t task_add_affinity(void (*task_function)(uint32_t, uint32_t*, char*), const uint32_t id,
+                               const uint8_t priority, const uint8_t core_mask) {
+    return task_add_args_affinity(task_function, id, "\0", priority, core_mask);
+}
+
 kelp_error_t task_add(void (*task_function)(uint32_t, uint32_t*, char*), const uint32_t id, const uint8_t priority) {
     return task_add_args(task_function, id, "\0", priority);
 }
@@ -804,7 +1606,7 @@ void idle_task(uint32_t pid, uint32_t* signals, char* args) {
 }
 
 void scheduler_start_this_core() {
-    task_add(idle_task, 0 + CORE_NUM, 0);
+    task_add_affinity(idle_task, 0 + CORE_NUM, 0, TASK_CORE(CORE_NUM));
     scheduler_t* scheduler = get_scheduler();
 #if CPU_FANCY_USAGE_MONITORING
     scheduler->us_executing = 0;
@@ -812,25 +1614,32 @@ void scheduler_start_this_core() {
     scheduler->ticks_executing = 0;
 #endif
     scheduler->ticks_since_start = 0;
+    scheduler->last_tick_us = time_us_64();
 
     NVIC_SetPriority(PendSV_IRQn, 3);
     NVIC_SetPriority(SysTick_IRQn, 2);
 
+#if CORE_COUNT > 1
+    start_multicore_signals();
+#endif
+
     if (num_tasks == 0) {
         PRINT_WARNING("No tasks to run\n");
         return; // no tasks
     }
 
-    PRINT_DEBUG("Starting Scheduler\n");
+    TRACE_EVENT(TRACE_START, 0, 0, CORE_NUM, 0);
 
-    get_next_task();
+#if STACK_GUARD_MPU
+    stack_guard_init();
+#endif
 
-    PRINT_DEBUG("Adding Timer...\n");
+    const uint32_t saved_irq = run_queue_spin_lock_this_core();
+    get_next_task();
+    run_queue_spin_unlock_this_core(saved_irq);
 
     start_systick();
 
-    PRINT_DEBUG("Timer Started!\n");
-
     set_spsel(2);
 }
 
@@ -845,6 +1654,23 @@ kelp_error_t kernel_start() {
     KELP_RETURN_ON_ERROR(error);
 #if USE_GOVERNOR
     governor_init();
+#endif
+    // housekeeping runs on core 0, where the tick hands it over
+    // (these go straight to add_task, as their ids are the ones task_add_* keeps from applications)
+    error = add_task(kernel_worker_task, KERNEL_WORKER_PID, "\0", KERNEL_WORKER_PRIORITY, TASK_CORE(0), 0, 0, 0);
+    KELP_RETURN_ON_ERROR(error);
+#if SOFT_TIMERS
+    error = add_task(soft_timer_task, SOFT_TIMER_PID, "\0", SOFT_TIMER_PRIORITY, TASK_ANY_CORE, 0, 0, 0);
+    KELP_RETURN_ON_ERROR(error);
+#endif
+#if WORK_QUEUE && WORK_QUEUE_PER_CORE
+    for (uint8_t c = 0; c < CORE_COUNT; c++) {
+        error = add_task(work_queue_task, WORK_QUEUE_PID + c, "\0", WORK_QUEUE_PRIORITY, TASK_CORE(c), 0, 0, 0);
+        KELP_RETURN_ON_ERROR(error);
+    }
+#elif WORK_QUEUE
+    error = add_task(work_queue_task, WORK_QUEUE_PID, "\0", WORK_QUEUE_PRIORITY, TASK_ANY_CORE, 0, 0, 0);
+    KELP_RETURN_ON_ERROR(error);
 #endif
 #if CORE_COUNT > 1
     multicore_reset_core1();
@@ -871,33 +1697,144 @@ void task_sleep_us(uint64_t us) {
         return;
     }
 
-    const uint32_t saved_irq = scheduler_spin_lock();
+    task_sleep_until(make_timeout_time_us(us));
+}
+
+void task_sleep_until(const absolute_time_t until) {
+    if (time_reached(until)) {
+        task_yield();
+        return;
+    }
+
     task_t* current_task = get_current_task();
-    current_task->state = TASK_WAIT_US;
-    current_task->resume_us = make_timeout_time_us(us);
-    scheduler_spin_unlock(saved_irq);
+    const uint32_t saved_irq = task_lock(current_task);
+    current_task->resume_us = until;
+    task_set_state(current_task, TASK_WAIT_US);
+    task_unlock(current_task, saved_irq);
     scheduler_raise_pendsv();
 }
 
-void task_yield() {
+void task_periodic_start(task_period_t* period, const uint32_t period_us) {
+    period->period_us = period_us;
+    period->next_us = time_us_64() + period_us;
+}
+
+uint32_t task_periodic_wait(task_period_t* period) {
+    const uint64_t now_us = time_us_64();
+    uint32_t skipped = 0;
+
+    // skip whole periods that are already over, instead of rushing through them to catch up
+    if (period->next_us <= now_us) {
+        skipped = (uint32_t)((now_us - period->next_us) / period->period_us) + 1;
+        period->next_us += (uint64_t)skipped * period->period_us;
+
+        // only the task itself writes this
+        get_current_task()->overruns += skipped;
+    }
+
+    task_sleep_until(from_us_since_boot(period->next_us));
+    period->next_us += period->period_us;
+
+    return skipped;
+}
+
+kelp_error_t task_get_overruns(const uint32_t pid, uint32_t* overruns) {
+    kelp_error_t error = KELP_NO_TASK;
+
     const uint32_t saved_irq = scheduler_spin_lock();
-    task_t* current_task = get_current_task();
-    current_task->state = TASK_YIELDING;
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        if (tasks[i].id == pid && tasks[i].state != TASK_FREE) {
+            *overruns = tasks[i].overruns;
+            error = KELP_OK;
+            break;
+        }
+    }
     scheduler_spin_unlock(saved_irq);
+
+    return error;
+}
+
+void task_yield() {
+    task_t* current_task = get_current_task();
+    const uint32_t saved_irq = task_lock(current_task);
+    task_set_state(current_task, TASK_YIELDING);
+    task_unlock(current_task, saved_irq);
+    scheduler_raise_pendsv();
+}
+
+#if DEADLINE_SCHEDULING
+void task_wait_next_period() {
+    task_t* current_task = get_current_task();
+
+    if (current_task->period_us == 0) {
+        task_yield();
+        return;
+    }
+
+    const uint32_t saved_irq = task_lock(current_task);
+    const uint64_t now_us = time_us_64();
+    task_deadline_stats_t* stats = &current_task->deadline_stats;
+
+    stats->periods++;
+    if (now_us > current_task->deadline_us) {
+        stats->deadline_misses++;
+    }
+    if (now_us - current_task->release_us > stats->worst_response_us) {
+        stats->worst_response_us = (uint32_t)(now_us - current_task->release_us);
+    }
+
+    // releases stay on the grid set by the first one, skipping the periods that are already over
+    current_task->release_us += current_task->period_us;
+    if (current_task->release_us <= now_us) {
+        const uint64_t behind = (now_us - current_task->release_us) / current_task->period_us + 1;
+        current_task->release_us += behind * current_task->period_us;
+        stats->deadline_misses += behind;
+    }
+
+    current_task->deadline_us = current_task->release_us + current_task->relative_deadline_us;
+    current_task->budget_used_us = 0;
+    current_task->throttled = false;
+
+    current_task->resume_us = from_us_since_boot(current_task->release_us);
+    task_set_state(current_task, TASK_WAIT_US);
+    task_unlock(current_task, saved_irq);
     scheduler_raise_pendsv();
 }
 
+kelp_error_t task_get_deadline_stats(const uint32_t pid, task_deadline_stats_t* stats) {
+    kelp_error_t error = KELP_NO_TASK;
+
+    const uint32_t saved_irq = scheduler_spin_lock();
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        if (tasks[i].id == pid && tasks[i].state != TASK_FREE) {
+            if (tasks[i].period_us == 0) {
+                error = KELP_WRONG_TYPE;
+            }
+            else {
+                *stats = tasks[i].deadline_stats;
+                error = KELP_OK;
+            }
+            break;
+        }
+    }
+    scheduler_spin_unlock(saved_irq);
+
+    return error;
+}
+#endif
+
 kelp_error_t task_request_stack(uint32_t stack_size) {
 #if DYNAMIC_STACK
-    const uint32_t saved_irq = scheduler_spin_lock();
     task_t* current_task = get_current_task();
-    current_task->state = TASK_STACK_OVERFLOWED;
+    const uint32_t saved_irq = task_lock(current_task);
     current_task->requested_stack_size = stack_size;
-    scheduler_spin_unlock(saved_irq);
+    task_set_state(current_task, TASK_STACK_OVERFLOWED);
+    task_unlock(current_task, saved_irq);
     scheduler_raise_pendsv();
 
+    // stacks are handed out in whole blocks, so it may have been given more
     current_task = get_current_task();
-    if (current_task->stack_size == stack_size) {
+    if (current_task->stack_size >= stack_size) {
         return KELP_OK;
     }
 #endif
@@ -953,6 +1890,32 @@ bool task_exists(uint32_t pid) {
     return exists;
 }
 
+// the task's run queue must be locked
+static void kill_task(task_t* task) {
+    if (task->state == TASK_ZOMBIE || task->state == TASK_DEAD) {
+        return;
+    }
+
+    if (task_is_running(task)) {
+        if (task_can_die(task)) {
+            task->state = TASK_ZOMBIE; // its core finishes it off as it switches it out
+        }
+        else if (task->state == TASK_BLOCKED) {
+            // it queued itself to wait but hasn't been switched out yet, so it stays on to find out it was killed
+            task_set_state(task, TASK_READY);
+        }
+        scheduler_reschedule_core(task->core);
+    }
+    else if (task_can_die(task)) {
+        task_set_state(task, TASK_DEAD);
+    }
+    else if (task->state == TASK_BLOCKED || task->state == TASK_STOPPED) {
+        // it has to run to get out of its wait queue (whose wait ends in KELP_KILLED) or let go of its mutexes,
+        // and dies the next time it is switched out after that
+        task_set_state(task, TASK_READY);
+    }
+}
+
 void task_signal(uint32_t pid, uint32_t signals) {
     task_t* task = NULL;
 
@@ -969,7 +1932,143 @@ void task_signal(uint32_t pid, uint32_t signals) {
         return;
     }
 
+    // the kernel's own tasks can't be killed or stopped
+    if (is_kernel_task(task)) {
+        signals &= ~(TASK_SIGKILL | TASK_SIGSTOP | TASK_SIGCONT);
+    }
+
+    const uint32_t task_irq = task_lock(task);
+
+    // whichever of stop and continue came last is the one that counts
+    if (signals & TASK_SIGCONT) {
+        task->signals &= ~TASK_SIGSTOP;
+    }
+    else if (signals & TASK_SIGSTOP) {
+        task->signals &= ~TASK_SIGCONT;
+    }
     task->signals |= signals;
 
+    if (signals & TASK_SIGKILL) {
+        task->signals &= ~TASK_SIGSTOP; // it may have to run a bit more to die
+        kill_task(task);
+    }
+    else if ((signals & TASK_SIGCONT) && task->state == TASK_STOPPED) {
+        task_set_state(task, TASK_READY);
+    }
+    else if ((task->signals & TASK_SIGSTOP) &&
+             (task->state == TASK_READY || task->state == TASK_RUNNING || task->state == TASK_YIELDING)) {
+        // a sleeping or blocked task stops as it is woken (see `task_enqueue`)
+        const bool running = task_is_running(task);
+        task_set_state(task, TASK_STOPPED);
+
+        if (running) {
+            scheduler_reschedule_core(task->core);
+        }
+    }
+
+    // wake it if it is waiting for one of these, it preempts whatever it outranks
+    if (task->state == TASK_BLOCKED && (task->signal_mask & signals) != 0) {
+        task_set_state(task, TASK_READY);
+    }
+
+    task_unlock(task, task_irq);
+    scheduler_spin_unlock(saved_irq);
+}
+
+uint32_t task_wait_signals(const uint32_t mask, const uint64_t timeout_us) {
+    if (is_privileged()) {
+        return 0; // only tasks can block
+    }
+
+    task_t* task = get_current_task();
+    const absolute_time_t until = timeout_us == TASK_WAIT_FOREVER ? at_the_end_of_time
+                                                                  : make_timeout_time_us(timeout_us);
+
+    uint32_t saved_irq = task_lock(task);
+
+    // `task_signal` wakes us while `signal_mask` is set, which it can only look at with our run queue locked,
+    // so a signal between here and the switch just makes us ready again before we go.
+    // a task being killed never blocks, it is only still here as it has mutexes to let go of
+    while ((task->signals & mask) == 0 && (task->signals & TASK_SIGKILL) == 0 && !time_reached(until)) {
+        task->signal_mask = mask;
+        task->resume_us = until;
+        task_set_state(task, TASK_BLOCKED);
+
+        task_unlock(task, saved_irq);
+        scheduler_raise_pendsv();
+        saved_irq = task_lock(task);
+
+        task->signal_mask = 0;
+    }
+
+    const uint32_t signals = task->signals & mask;
+
+    task_unlock(task, saved_irq);
+    return signals;
+}
+
+uint32_t task_take_signals(const uint32_t mask) {
+    task_t* task = get_current_task();
+    const uint32_t saved_irq = task_lock(task);
+
+    const uint32_t signals = task->signals & mask;
+    task->signals &= ~mask;
+
+    task_unlock(task, saved_irq);
+    return signals;
+}
+
+kelp_error_t task_set_affinity(uint32_t pid, uint8_t core_mask) {
+    core_mask &= TASK_ALL_CORES;
+    if (core_mask == 0) {
+        return KELP_NOT_SUPPORTED; // none of the cores in the mask exist
+    }
+
+    if (pid < CORE_COUNT) {
+        return KELP_INVALID_ID; // idle tasks stay where they are
+    }
+
+    task_t* task = NULL;
+
+    const uint32_t saved_irq = scheduler_spin_lock();
+    for (uint32_t i = 0; i < MAX_TASKS; i++) {
+        if (tasks[i].id == pid && tasks[i].state != TASK_FREE) {
+            task = &tasks[i];
+            break;
+        }
+    }
+
+    if (task == NULL) {
+        scheduler_spin_unlock(saved_irq);
+        return KELP_NO_TASK;
+    }
+
+    const uint32_t task_irq = task_lock(task);
+    const uint8_t old_core = task->core;
+    task->affinity = core_mask;
+
+    if (!task_allowed_on_core(task, old_core)) {
+        if (task_is_running(task)) {
+            // it moves over when its core switches it out
+            scheduler_reschedule_core(old_core);
+        }
+        else {
+            // only holders of the scheduler spinlock ever wait on a second run queue, so this can't deadlock
+            const uint8_t new_core = pick_core_for_task(task);
+
+            run_queue_spin_lock_unsafe(new_core);
+            task_dequeue(task);
+            task->core = new_core;
+            task_enqueue(task);
+            run_queue_spin_unlock_unsafe(new_core);
+
+            if (task->state == TASK_READY) {
+                preempt_for_task(task);
+            }
+        }
+    }
+
+    run_queue_spin_unlock(old_core, task_irq);
     scheduler_spin_unlock(saved_irq);
+    return KELP_OK;
 }
@@ -0,0 +1,164 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "soft_timer.h"
+
+#include <stddef.h>
+
+#include "pico/time.h"
+#include "scheduler_internal.h"
+#include "spinlock_internal.h"
+
+#if SOFT_TIMERS
+
+static kelp_timer_t *armed_timers;  // earliest due first
+static wait_queue_t service_waiter; // the service task, while it sleeps until the first timer is due
+
+// the sync lock must be held
+static void timer_insert(kelp_timer_t *timer) {
+    kelp_timer_t **link = &armed_timers;
+
+    // after every timer due at the same time, so they go in the order they were started
+    while (*link != NULL && (*link)->expiry_us <= timer->expiry_us) {
+        link = &(*link)->next;
+    }
+
+    timer->next = *link;
+    *link = timer;
+    timer->active = true;
+}
+
+// the sync lock must be held
+static void timer_remove(kelp_timer_t *timer) {
+    kelp_timer_t **link = &armed_timers;
+
+    while (*link != NULL && *link != timer) {
+        link = &(*link)->next;
+    }
+
+    if (*link != NULL) {
+        *link = timer->next;
+    }
+
+    timer->next = NULL;
+    timer->active = false;
+}
+
+// the sync lock must be held, the service task only needs waking if the first timer changed
+static void timer_arm(kelp_timer_t *timer) {
+    if (timer->active) {
+        timer_remove(timer);
+    }
+
+    timer->expiry_us = time_us_64() + timer->period_us;
+    timer_insert(timer);
+
+    if (armed_timers == timer) {
+        wait_queue_wake_one(&service_waiter);
+    }
+}
+
+kelp_error_t kelp_timer_init(kelp_timer_t *timer, const kelp_timer_callback_t callback, void *arg,
+                             const uint32_t period_us, const bool auto_reload) {
+    if (period_us == 0) {
+        return KELP_NOT_SUPPORTED;
+    }
+
+    timer->callback = callback;
+    timer->arg = arg;
+    timer->period_us = period_us;
+    timer->expiry_us = 0;
+    timer->auto_reload = auto_reload;
+    timer->active = false;
+    timer->next = NULL;
+    return KELP_OK;
+}
+
+kelp_error_t kelp_timer_start(kelp_timer_t *timer) {
+    const uint32_t saved_irq = sync_spin_lock();
+    timer_arm(timer);
+    sync_spin_unlock(saved_irq);
+    return KELP_OK;
+}
+
+kelp_error_t kelp_timer_stop(kelp_timer_t *timer) {
+    const uint32_t saved_irq = sync_spin_lock();
+
+    if (!timer->active) {
+        sync_spin_unlock(saved_irq);
+        return KELP_NOT_SUPPORTED;
+    }
+
+    // the service task may sleep a little past where this one was due, and find nothing to do
+    timer_remove(timer);
+
+    sync_spin_unlock(saved_irq);
+    return KELP_OK;
+}
+
+kelp_error_t kelp_timer_change_period(kelp_timer_t *timer, const uint32_t period_us) {
+    if (period_us == 0) {
+        return KELP_NOT_SUPPORTED;
+    }
+
+    const uint32_t saved_irq = sync_spin_lock();
+    timer->period_us = period_us;
+    timer_arm(timer);
+    sync_spin_unlock(saved_irq);
+    return KELP_OK;
+}
+
+bool kelp_timer_is_active(const kelp_timer_t *timer) {
+    return timer->active;
+}
+
+void soft_timer_task(uint32_t pid, uint32_t *signals, char *args) {
+    uint32_t saved_irq = sync_spin_lock();
+
+    while (true) {
+        kelp_timer_t *timer = armed_timers;
+        const uint64_t now_us = time_us_64();
+
+        if (timer != NULL && timer->expiry_us <= now_us) {
+            armed_timers = timer->next;
+            timer->next = NULL;
+            timer->active = false;
+
+            if (timer->auto_reload) {
+                // keep to its schedule, but skip the periods it is behind by whole instead of going off in a burst
+                timer->expiry_us += timer->period_us;
+                if (timer->expiry_us <= now_us) {
+                    timer->expiry_us = now_us + timer->period_us - (now_us - timer->expiry_us) % timer->period_us;
+                }
+                timer_insert(timer);
+            }
+
+            // the callback may start, stop or change any timer, this one included
+            const kelp_timer_callback_t callback = timer->callback;
+            void *arg = timer->arg;
+
+            sync_spin_unlock(saved_irq);
+            callback(timer, arg);
+            saved_irq = sync_spin_lock();
+            continue;
+        }
+
+        const absolute_time_t until = timer != NULL ? from_us_since_boot(timer->expiry_us) : at_the_end_of_time;
+        task_wait_prepare(&service_waiter, until);
+
+        sync_spin_unlock(saved_irq);
+        scheduler_raise_pendsv();
+        saved_irq = sync_spin_lock();
+
+        task_wait_finish(&service_waiter);
+    }
+}
+
+#else
+
+void soft_timer_task(uint32_t pid, uint32_t *signals, char *args) {
+    // there are no timers to run
+}
+
+#endif
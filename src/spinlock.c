@@ -9,6 +9,9 @@ spin_lock_t *spin_lock_scheduler;
 spin_lock_t *spin_lock_channel;
 
 spin_lock_t *channel_spin_locks[NUM_CHANNEL_SPINLOCKS];
+spin_lock_t *run_queue_spin_locks[CORE_COUNT];
+spin_lock_t *spin_lock_stack_pool;
+spin_lock_t *spin_lock_sync;
 
 void spin_locks_init() {
     spin_lock_claim(SCHEDULER_SPINLOCK_ID);
@@ -19,6 +22,14 @@ void spin_locks_init() {
         channel_spin_locks[i] = spin_lock_init(lock_num);
     }
 
+    for (uint32_t i = 0; i < CORE_COUNT; i++) {
+        int lock_num = spin_lock_claim_unused(true);
+        run_queue_spin_locks[i] = spin_lock_init(lock_num);
+    }
+
+    spin_lock_stack_pool = spin_lock_init(spin_lock_claim_unused(true));
+    spin_lock_sync = spin_lock_init(spin_lock_claim_unused(true));
+
     spin_lock_scheduler = spin_lock_init(SCHEDULER_SPINLOCK_ID);
     spin_lock_channel = spin_lock_init(CHANNEL_SPINLOCK_ID);
 }
@@ -44,6 +55,34 @@ inline void scheduler_spin_unlock_unsafe() {
     spin_unlock_unsafe(spin_lock_scheduler);
 }
 
+inline uint32_t run_queue_spin_lock(uint8_t core) {
+    return spin_lock_blocking(run_queue_spin_locks[core]);
+}
+
+inline void run_queue_spin_lock_unsafe(uint8_t core) {
+    spin_lock_unsafe_blocking(run_queue_spin_locks[core]);
+}
+
+inline bool run_queue_spin_try_lock_unsafe(uint8_t core) {
+    return spin_try_lock_unsafe(run_queue_spin_locks[core]);
+}
+
+inline void run_queue_spin_unlock(uint8_t core, const uint32_t irqs) {
+    spin_unlock(run_queue_spin_locks[core], irqs);
+}
+
+inline void run_queue_spin_unlock_unsafe(uint8_t core) {
+    spin_unlock_unsafe(run_queue_spin_locks[core]);
+}
+
+uint32_t run_queue_spin_lock_this_core() {
+    return run_queue_spin_lock(get_core_num());
+}
+
+void run_queue_spin_unlock_this_core(const uint32_t irqs) {
+    run_queue_spin_unlock(get_core_num(), irqs);
+}
+
 inline bool global_channel_spin_locked() {
     return is_spin_locked(spin_lock_channel);
 }
@@ -92,6 +131,22 @@ inline void channel_spin_unlock_unsafe(uint16_t channel_id) {
     spin_lock_t *lock = get_channel_spin_lock(channel_id);
     spin_unlock_unsafe(lock);
 }
+
+inline uint32_t stack_pool_spin_lock() {
+    return spin_lock_blocking(spin_lock_stack_pool);
+}
+
+inline void stack_pool_spin_unlock(const uint32_t irqs) {
+    spin_unlock(spin_lock_stack_pool, irqs);
+}
+
+inline uint32_t sync_spin_lock() {
+    return spin_lock_blocking(spin_lock_sync);
+}
+
+inline void sync_spin_unlock(const uint32_t irqs) {
+    spin_unlock(spin_lock_sync, irqs);
+}
 #else
 inline bool scheduler_spin_locked() {
     return false;
@@ -111,6 +166,32 @@ inline void scheduler_spin_unlock(const uint32_t irqs) {
 inline void scheduler_spin_unlock_unsafe() {
 }
 
+inline uint32_t run_queue_spin_lock(uint8_t core) {
+    return save_and_disable_interrupts();
+}
+
+inline void run_queue_spin_lock_unsafe(uint8_t core) {
+}
+
+inline bool run_queue_spin_try_lock_unsafe(uint8_t core) {
+    return true;
+}
+
+inline void run_queue_spin_unlock(uint8_t core, const uint32_t irqs) {
+    restore_interrupts_from_disabled(irqs);
+}
+
+inline void run_queue_spin_unlock_unsafe(uint8_t core) {
+}
+
+uint32_t run_queue_spin_lock_this_core() {
+    return save_and_disable_interrupts();
+}
+
+void run_queue_spin_unlock_this_core(const uint32_t irqs) {
+    restore_interrupts_from_disabled(irqs);
+}
+
 inline bool global_channel_spin_locked() {
     return false;
 }
@@ -146,4 +227,20 @@ inline void channel_spin_unlock(uint16_t channel_id, const uint32_t irqs) {
 
 inline void channel_spin_unlock_unsafe(uint16_t channel_id) {
 }
-#endif
\ No newline at end of file
+
+inline uint32_t stack_pool_spin_lock() {
+    return save_and_disable_interrupts();
+}
+
+inline void stack_pool_spin_unlock(const uint32_t irqs) {
+    restore_interrupts_from_disabled(irqs);
+}
+
+inline uint32_t sync_spin_lock() {
+    return save_and_disable_interrupts();
+}
+
+inline void sync_spin_unlock(const uint32_t irqs) {
+    restore_interrupts_from_disabled(irqs);
+}
+#endif
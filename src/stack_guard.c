@@ -0,0 +1,76 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "stack_guard.h"
+
+#if STACK_GUARD_MPU
+
+#include "hardware/structs/mpu.h"
+#include "hardware/sync.h"
+
+/*
+ * The Cortex-M0+ MPU has 8 regions of at least 256 bytes, each aligned to its size.
+ * Stacks from the pool start on a block boundary, which the pool keeps aligned, so the bottom
+ * STACK_GUARD_WORDS of a stack always make a region of their own.
+ * The region allows no access at all, even from handlers, and the default memory map covers the rest.
+ *
+ * The M0+ has no MemManage fault, so running into the guard ends up in the HardFault handler,
+ * which finds the guard from the stack pointer the task had when it faulted (see `stack_guard_hit`).
+ * The core pushes the exception frame below that stack pointer, and a frame pushed into the guard
+ * faults again during HardFault entry, which locks an ARMv6-M core up. So only a fault that leaves room
+ * for the frame above the guard can be caught and the task grown, anything deeper locks up the core
+ * rather than corrupting what is below the stack.
+ */
+
+#define STACK_GUARD_SIZE_BITS 7     // the region is 2^(7 + 1) = 256 bytes
+#define STACK_GUARD_NO_ACCESS_XN 0x10000000 // AP = 0 (no access), XN = 1
+
+#define STACK_GUARD_FRAME_WORDS 8   // r0-r3, r12, lr, pc and xPSR, pushed by the core on the way into the fault
+#define STACK_GUARD_ALIGNED_BIT 9   // set in the stacked xPSR when a word was skipped to align the frame
+
+// the deepest push (r0-r7 and lr) reaches this far below the stack pointer, so a fault with the stack pointer
+// this close above the guard (and the frame pushed into the room above it) is an overflow
+#define STACK_GUARD_MARGIN (9 + STACK_GUARD_FRAME_WORDS + 1)
+
+void stack_guard_init() {
+    mpu_hw->ctrl = 0;
+
+    mpu_hw->rnr = STACK_GUARD_REGION;
+    mpu_hw->rasr = 0;
+
+    // privileged code sees the default memory map outside of our regions, and HardFault ignores the MPU
+    mpu_hw->ctrl = M0PLUS_MPU_CTRL_PRIVDEFENA_BITS | M0PLUS_MPU_CTRL_ENABLE_BITS;
+    __dsb();
+    __isb();
+}
+
+void stack_guard_set(const uint32_t* stack) {
+    mpu_hw->rbar = (uint32_t)(uintptr_t)stack | M0PLUS_MPU_RBAR_VALID_BITS | STACK_GUARD_REGION;
+    mpu_hw->rasr = STACK_GUARD_NO_ACCESS_XN | (STACK_GUARD_SIZE_BITS << M0PLUS_MPU_RASR_SIZE_LSB) |
+                   M0PLUS_MPU_RASR_ENABLE_BITS;
+    __dsb();
+    __isb();
+}
+
+void stack_guard_clear() {
+    mpu_hw->rnr = STACK_GUARD_REGION;
+    mpu_hw->rasr = 0;
+    __dsb();
+    __isb();
+}
+
+bool stack_guard_hit(const uint32_t* stack, const uint32_t* frame) {
+    const uint32_t* guard_top = stack + STACK_GUARD_WORDS;
+
+    if (frame < guard_top) {
+        return false; // the frame can't have been pushed into the guard, this came from somewhere else
+    }
+
+    // the stack pointer the task had before the core pushed the frame
+    const uint32_t* psp = frame + STACK_GUARD_FRAME_WORDS + ((frame[7] >> STACK_GUARD_ALIGNED_BIT) & 1);
+
+    return psp < guard_top + STACK_GUARD_MARGIN;
+}
+
+#endif
@@ -0,0 +1,354 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "stack_pool.h"
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "spinlock_internal.h"
+
+#if STACK_POOL
+
+/*
+ * The pool is a row of STACK_POOL_MAX_BLOCK sized blocks, each split in halves as smaller stacks are wanted.
+ * A block of order `n` is STACK_POOL_MIN_BLOCK << n words, and its buddy is the other half of the block it was split from.
+ * Freed blocks merge back with their buddy whenever it is free too, so the pool can't fragment past one half per size.
+ *
+ * Stacks grow down from the end of their block, so a stack is handed the upper half of every block split for it.
+ * The lower halves stay free for as long as nobody else needs them, and the stack can grow down into them in place.
+ * Free memory is always STACK_FILLER (but for the free list links at the start of each free block),
+ * so grown stacks and new ones are ready for stack monitoring without being filled.
+ */
+
+#define STACK_POOL_UNITS (STACK_POOL_SIZE / STACK_POOL_MIN_BLOCK)   // smallest blocks that fit in the pool
+#define STACK_POOL_BLOCK_FREE 0x80                                  // flag in `block_info`, the rest is the order
+#define STACK_POOL_LINK_WORDS ((sizeof(stack_pool_block_t) + sizeof(uint32_t) - 1) / sizeof(uint32_t))
+
+// a free block holds its own free list links
+typedef struct stack_pool_block_s {
+    struct stack_pool_block_s* next;
+    struct stack_pool_block_s* prev;
+} stack_pool_block_t;
+
+// with STACK_GUARD_MPU every block has to start on an MPU region boundary
+#if STACK_GUARD_MPU
+static uint32_t stack_pool[STACK_POOL_SIZE] __attribute__((aligned(STACK_GUARD_WORDS * sizeof(uint32_t))));
+#else
+static uint32_t stack_pool[STACK_POOL_SIZE];
+#endif
+static uint8_t block_info[STACK_POOL_UNITS];    // order and free flag of each block, kept at its first unit
+static stack_pool_block_t* free_lists[STACK_POOL_MAX_CLASSES];
+static uint8_t top_order;
+static bool initialized = false;
+static stack_pool_stats_t stats;
+
+static inline uint32_t order_words(const uint8_t order) {
+    return (uint32_t)STACK_POOL_MIN_BLOCK << order;
+}
+
+static inline uint32_t order_units(const uint8_t order) {
+    return (uint32_t)1 << order;
+}
+
+static inline uint32_t unit_of(const uint32_t* block) {
+    return (uint32_t)(block - stack_pool) / STACK_POOL_MIN_BLOCK;
+}
+
+static inline uint32_t* unit_address(const uint32_t unit) {
+    return &stack_pool[unit * STACK_POOL_MIN_BLOCK];
+}
+
+// the smallest order that holds `words`, or top_order + 1 if none do
+static uint8_t order_for(const uint32_t words) {
+    uint8_t order = 0;
+
+    while (order <= top_order && order_words(order) < words) {
+        order++;
+    }
+
+    return order;
+}
+
+// a block leaving the free lists gets the filler back where its links were
+static void refill_links(const uint32_t unit) {
+    uint32_t* words = unit_address(unit);
+
+    for (uint32_t i = 0; i < STACK_POOL_LINK_WORDS; i++) {
+        words[i] = STACK_FILLER;
+    }
+}
+
+static void fill(uint32_t* words, const uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        words[i] = STACK_FILLER;
+    }
+}
+
+static void free_list_push(const uint32_t unit, const uint8_t order) {
+    stack_pool_block_t* block = (stack_pool_block_t*)unit_address(unit);
+
+    block->prev = NULL;
+    block->next = free_lists[order];
+    if (block->next != NULL) {
+        block->next->prev = block;
+    }
+    free_lists[order] = block;
+
+    block_info[unit] = order | STACK_POOL_BLOCK_FREE;
+    stats.free_blocks[order]++;
+}
+
+static void free_list_remove(const uint32_t unit, const uint8_t order) {
+    stack_pool_block_t* block = (stack_pool_block_t*)unit_address(unit);
+
+    if (block->prev != NULL) {
+        block->prev->next = block->next;
+    }
+    else {
+        free_lists[order] = block->next;
+    }
+    if (block->next != NULL) {
+        block->next->prev = block->prev;
+    }
+
+    block_info[unit] = order;
+    stats.free_blocks[order]--;
+}
+
+static void stack_pool_init() {
+    top_order = 0;
+    while (order_words(top_order) < STACK_POOL_MAX_BLOCK) {
+        top_order++;
+    }
+
+    stats.size = STACK_POOL_SIZE;
+    fill(stack_pool, STACK_POOL_SIZE);
+
+    for (uint32_t unit = 0; unit < STACK_POOL_UNITS; unit += STACK_POOL_MAX_BLOCK / STACK_POOL_MIN_BLOCK) {
+        free_list_push(unit, top_order);
+    }
+
+    initialized = true;
+}
+
+uint32_t* stack_pool_alloc(const uint32_t words, uint32_t* block_words) {
+    const uint32_t saved_irq = stack_pool_spin_lock();
+
+    // tasks are added before the kernel starts, so the first one sets the pool up
+    if (!initialized) {
+        stack_pool_init();
+    }
+
+    const uint8_t order = order_for(words);
+
+    // the smallest free block that is big enough
+    uint8_t found = order;
+    while (found <= top_order && free_lists[found] == NULL) {
+        found++;
+    }
+
+    if (found > top_order) {
+        stats.failed++;
+        stack_pool_spin_unlock(saved_irq);
+        return NULL;
+    }
+
+    uint32_t unit = unit_of((uint32_t*)free_lists[found]);
+    free_list_remove(unit, found);
+    refill_links(unit);
+
+    // hand back the lower halves until it is the right size, leaving room below to grow into
+    while (found > order) {
+        found--;
+        free_list_push(unit, found);
+        unit += order_units(found);
+    }
+    block_info[unit] = order;
+
+    stats.used += order_words(order);
+    stats.allocations++;
+    if (stats.used > stats.high_water) {
+        stats.high_water = stats.used;
+    }
+
+    stack_pool_spin_unlock(saved_irq);
+
+    *block_words = order_words(order);
+    return unit_address(unit);
+}
+
+void stack_pool_free(uint32_t* stack) {
+    if (stack == NULL) {
+        return;
+    }
+
+    uint32_t unit = unit_of(stack);
+    uint8_t order = block_info[unit];
+
+    // the block is still ours, so it can be cleaned up before locking
+    fill(stack, order_words(order));
+
+    const uint32_t saved_irq = stack_pool_spin_lock();
+
+    stats.used -= order_words(order);
+
+    // merge with the buddy for as long as it is free and whole
+    while (order < top_order) {
+        const uint32_t buddy = unit ^ order_units(order);
+
+        if (block_info[buddy] != (order | STACK_POOL_BLOCK_FREE)) {
+            break;
+        }
+
+        free_list_remove(buddy, order);
+        refill_links(buddy);
+        block_info[buddy] = 0;
+        block_info[unit] = 0;
+
+        if (buddy < unit) {
+            unit = buddy;
+        }
+        order++;
+    }
+
+    free_list_push(unit, order);
+
+    stack_pool_spin_unlock(saved_irq);
+}
+
+bool stack_pool_grow(uint32_t** stack, const uint32_t words, uint32_t* block_words) {
+    const uint32_t saved_irq = stack_pool_spin_lock();
+
+    const uint32_t start = unit_of(*stack);
+    const uint8_t order = block_info[start];
+    const uint8_t target = order_for(words);
+
+    if (target > top_order) {
+        stack_pool_spin_unlock(saved_irq);
+        return false;
+    }
+
+    // it can only grow if it is the upper half at every size up to the target, with the lower half free
+    uint32_t unit = start;
+    for (uint8_t o = order; o < target; o++) {
+        if ((unit & order_units(o)) == 0 || block_info[unit - order_units(o)] != (o | STACK_POOL_BLOCK_FREE)) {
+            stack_pool_spin_unlock(saved_irq);
+            return false;
+        }
+        unit -= order_units(o);
+    }
+
+    unit = start;
+    for (uint8_t o = order; o < target; o++) {
+        block_info[unit] = 0;
+        unit -= order_units(o);
+        free_list_remove(unit, o);
+        refill_links(unit);
+    }
+    block_info[unit] = target;
+
+    stats.used += order_words(target) - order_words(order);
+    if (stats.used > stats.high_water) {
+        stats.high_water = stats.used;
+    }
+
+    stack_pool_spin_unlock(saved_irq);
+
+    *stack = unit_address(unit);
+    *block_words = order_words(target);
+    return true;
+}
+
+bool stack_pool_shrink(uint32_t** stack, const uint32_t words, uint32_t* block_words) {
+    uint32_t unit = unit_of(*stack);
+    uint8_t order = block_info[unit];
+    const uint8_t target = order_for(words);
+
+    if (target >= order) {
+        return false;
+    }
+
+    // the bottom of the stack is still ours until it is handed back, so it can be cleaned up before locking
+    const uint32_t released = order_words(order) - order_words(target);
+    fill(*stack, released);
+
+    const uint32_t saved_irq = stack_pool_spin_lock();
+
+    block_info[unit] = 0;
+    while (order > target) {
+        order--;
+        free_list_push(unit, order); // its buddy is the half we keep, so there is nothing to merge with
+        unit += order_units(order);
+    }
+    block_info[unit] = target;
+
+    stats.used -= released;
+
+    stack_pool_spin_unlock(saved_irq);
+
+    *stack = unit_address(unit);
+    *block_words = order_words(target);
+    return true;
+}
+
+uint32_t stack_pool_block_words(const uint32_t words) {
+    uint32_t block = STACK_POOL_MIN_BLOCK;
+
+    while (block < words && block < STACK_POOL_MAX_BLOCK) {
+        block <<= 1;
+    }
+
+    return block;
+}
+
+void stack_pool_get_stats(stack_pool_stats_t* out) {
+    const uint32_t saved_irq = stack_pool_spin_lock();
+
+    if (!initialized) {
+        stack_pool_init();
+    }
+
+    *out = stats;
+
+    out->largest_free = 0;
+    for (int8_t order = (int8_t)top_order; order >= 0; order--) {
+        if (free_lists[order] != NULL) {
+            out->largest_free = order_words(order);
+            break;
+        }
+    }
+
+    stack_pool_spin_unlock(saved_irq);
+}
+
+#else
+
+uint32_t* stack_pool_alloc(const uint32_t words, uint32_t* block_words) {
+    *block_words = words;
+    return (uint32_t*)malloc(words * sizeof(uint32_t));
+}
+
+void stack_pool_free(uint32_t* stack) {
+    free(stack);
+}
+
+bool stack_pool_grow(uint32_t** stack, const uint32_t words, uint32_t* block_words) {
+    return false; // the heap can't grow a block downwards
+}
+
+bool stack_pool_shrink(uint32_t** stack, const uint32_t words, uint32_t* block_words) {
+    return false;
+}
+
+uint32_t stack_pool_block_words(const uint32_t words) {
+    return words;
+}
+
+void stack_pool_get_stats(stack_pool_stats_t* out) {
+    memset(out, 0, sizeof(*out));
+}
+
+#endif
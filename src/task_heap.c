@@ -0,0 +1,121 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "task_heap.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "scheduler_internal.h"
+
+static inline void place_node(task_heap_t *heap, const uint32_t index, const task_heap_node_t node) {
+    heap->nodes[index] = node;
+    node.task->heap_index = index;
+}
+
+// move the node at `index` towards the root until its parent is smaller
+static void sift_up(task_heap_t *heap, uint32_t index) {
+    const task_heap_node_t node = heap->nodes[index];
+
+    while (index > 0) {
+        const uint32_t parent = (index - 1) / 2;
+
+        if (heap->nodes[parent].key <= node.key) {
+            break;
+        }
+
+        place_node(heap, index, heap->nodes[parent]);
+        index = parent;
+    }
+
+    place_node(heap, index, node);
+}
+
+// move the node at `index` towards the leaves until both children are larger
+static void sift_down(task_heap_t *heap, uint32_t index) {
+    const task_heap_node_t node = heap->nodes[index];
+
+    while (true) {
+        const uint32_t left = (index * 2) + 1;
+        const uint32_t right = left + 1;
+        uint32_t smallest = index;
+        uint64_t smallest_key = node.key;
+
+        if (left < heap->count && heap->nodes[left].key < smallest_key) {
+            smallest = left;
+            smallest_key = heap->nodes[left].key;
+        }
+
+        if (right < heap->count && heap->nodes[right].key < smallest_key) {
+            smallest = right;
+        }
+
+        if (smallest == index) {
+            break;
+        }
+
+        place_node(heap, index, heap->nodes[smallest]);
+        index = smallest;
+    }
+
+    place_node(heap, index, node);
+}
+
+void task_heap_init(task_heap_t *heap) {
+    heap->count = 0;
+}
+
+void task_heap_push(task_heap_t *heap, task_t *task, const uint64_t key) {
+    const uint32_t index = heap->count++;
+
+    heap->nodes[index].key = key;
+    heap->nodes[index].task = task;
+    task->heap_index = index;
+
+    sift_up(heap, index);
+}
+
+void task_heap_remove(task_heap_t *heap, task_t *task) {
+    const uint32_t index = task->heap_index;
+    const uint32_t last = --heap->count;
+
+    if (index != last) {
+        // fill the hole with the last node, then let it find its place
+        const uint64_t removed_key = heap->nodes[index].key;
+        place_node(heap, index, heap->nodes[last]);
+
+        if (heap->nodes[index].key < removed_key) {
+            sift_up(heap, index);
+        }
+        else {
+            sift_down(heap, index);
+        }
+    }
+}
+
+task_t *task_heap_peek(const task_heap_t *heap) {
+    if (heap->count == 0) {
+        return NULL;
+    }
+
+    return heap->nodes[0].task;
+}
+
+uint64_t task_heap_peek_key(const task_heap_t *heap) {
+    if (heap->count == 0) {
+        return UINT64_MAX;
+    }
+
+    return heap->nodes[0].key;
+}
+
+task_t *task_heap_pop(task_heap_t *heap) {
+    task_t *task = task_heap_peek(heap);
+
+    if (task != NULL) {
+        task_heap_remove(heap, task);
+    }
+
+    return task;
+}
@@ -0,0 +1,127 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "trace_internal.h"
+#include "trace.h"
+
+#include <stdio.h>
+
+#include "hardware/sync.h"
+#include "hardware/timer.h"
+#include "scheduler.h"
+#include "scheduler_internal.h"
+
+#if TRACE
+
+static trace_buffer_t trace_buffers[CORE_COUNT];
+
+void trace_record(const uint8_t type, const uint8_t detail, const uint16_t value, const uint32_t a, const uint32_t b) {
+    // interrupts on this core are the only other writers, so keeping them out is enough
+    const uint32_t saved_irq = save_and_disable_interrupts();
+
+    trace_buffer_t* buffer = &trace_buffers[CORE_NUM];
+    const uint32_t head = buffer->head;
+    trace_event_t* event = &buffer->events[head & TRACE_BUFFER_MASK];
+
+    event->time_us = time_us_32();
+    event->type = type;
+    event->detail = detail;
+    event->value = value;
+    event->a = a;
+    event->b = b;
+
+    // the event has to be in place before a reader can see it
+    __dmb();
+    buffer->head = head + 1;
+
+    restore_interrupts(saved_irq);
+}
+
+uint32_t trace_read(const uint8_t core, trace_event_t* events, const uint32_t max) {
+    if (core >= CORE_COUNT) {
+        return 0;
+    }
+
+    trace_buffer_t* buffer = &trace_buffers[core];
+    const uint32_t head = buffer->head;
+    __dmb();
+
+    uint32_t next = buffer->read;
+
+    // skip what has already been overwritten
+    if (head - next > TRACE_BUFFER_SIZE) {
+        buffer->dropped += head - next - TRACE_BUFFER_SIZE;
+        next = head - TRACE_BUFFER_SIZE;
+    }
+
+    uint32_t count = 0;
+    while (next != head && count < max) {
+        events[count] = buffer->events[next & TRACE_BUFFER_MASK];
+        __dmb();
+
+        // the core may have come around and started writing over it while we copied,
+        // an event is only safe while its slot is not the one `head` points to
+        if (buffer->head - next >= TRACE_BUFFER_SIZE) {
+            buffer->dropped++;
+        }
+        else {
+            count++;
+        }
+
+        next++;
+    }
+
+    buffer->read = next;
+    return count;
+}
+
+uint32_t trace_dropped(const uint8_t core) {
+    if (core >= CORE_COUNT) {
+        return 0;
+    }
+
+    return trace_buffers[core].dropped;
+}
+
+void trace_stream_task(uint32_t pid, uint32_t* signals, char* args) {
+    trace_event_t events[16];
+    uint32_t dropped[CORE_COUNT] = {0};
+
+    while (true) {
+        for (uint8_t c = 0; c < CORE_COUNT; c++) {
+            uint32_t count;
+
+            while ((count = trace_read(c, events, sizeof(events) / sizeof(events[0]))) > 0) {
+                for (uint32_t e = 0; e < count; e++) {
+                    const trace_event_t* event = &events[e];
+                    printf("@T %u %lu %u %u %u %lu %lu\n", c, (unsigned long)event->time_us, event->type,
+                           event->detail, event->value, (unsigned long)event->a, (unsigned long)event->b);
+                }
+            }
+
+            if (trace_dropped(c) != dropped[c]) {
+                dropped[c] = trace_dropped(c);
+                printf("@D %u %lu\n", c, (unsigned long)dropped[c]);
+            }
+        }
+
+        task_sleep_ms(TRACE_STREAM_PERIOD_MS);
+    }
+}
+
+#else
+
+uint32_t trace_read(const uint8_t core, trace_event_t* events, const uint32_t max) {
+    return 0;
+}
+
+uint32_t trace_dropped(const uint8_t core) {
+    return 0;
+}
+
+void trace_stream_task(uint32_t pid, uint32_t* signals, char* args) {
+    // nothing is ever traced
+}
+
+#endif
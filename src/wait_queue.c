@@ -0,0 +1,197 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "wait_queue.h"
+
+#include <stddef.h>
+
+#include "pico/time.h"
+#include "scheduler_internal.h"
+
+static void wait_queue_append(wait_queue_t *queue, task_t *task) {
+    task->wait_next = NULL;
+    task->wait_prev = queue->tail;
+
+    if (queue->tail == NULL) {
+        queue->head = task;
+    }
+    else {
+        queue->tail->wait_next = task;
+    }
+
+    queue->tail = task;
+    task->wait_queue = queue;
+}
+
+// in front of the first task with a lower priority
+static void wait_queue_insert_by_priority(wait_queue_t *queue, task_t *task) {
+    task_t *before = queue->head;
+    while (before != NULL && before->priority >= task->priority) {
+        before = before->wait_next;
+    }
+
+    if (before == NULL) {
+        wait_queue_append(queue, task);
+        return;
+    }
+
+    task->wait_next = before;
+    task->wait_prev = before->wait_prev;
+
+    if (before->wait_prev == NULL) {
+        queue->head = task;
+    }
+    else {
+        before->wait_prev->wait_next = task;
+    }
+
+    before->wait_prev = task;
+    task->wait_queue = queue;
+}
+
+static void wait_queue_unlink(wait_queue_t *queue, task_t *task) {
+    if (task->wait_prev == NULL) {
+        queue->head = task->wait_next;
+    }
+    else {
+        task->wait_prev->wait_next = task->wait_next;
+    }
+
+    if (task->wait_next == NULL) {
+        queue->tail = task->wait_prev;
+    }
+    else {
+        task->wait_next->wait_prev = task->wait_prev;
+    }
+
+    task->wait_next = NULL;
+    task->wait_prev = NULL;
+    task->wait_queue = NULL;
+}
+
+// make a blocked task ready, returns false if it isn't blocked anymore (it timed out)
+static bool wake_task(task_t *task) {
+    const uint32_t saved_irq = task_lock(task);
+
+    const bool blocked = task->state == TASK_BLOCKED;
+    if (blocked) {
+        task_set_state(task, TASK_READY);
+    }
+
+    task_unlock(task, saved_irq);
+    return blocked;
+}
+
+void wait_queue_init(wait_queue_t *queue) {
+    queue->head = NULL;
+    queue->tail = NULL;
+}
+
+// block the current task in a wait queue it was just put in, unless it is being killed
+static kelp_error_t wait_prepare(wait_queue_t *queue, const absolute_time_t until, const bool by_priority) {
+    task_t *task = get_current_task();
+
+    // `task_signal` raises signals with our run queue locked, so no kill can slip in between this and blocking,
+    // and one that comes after finds us blocked and makes us ready to find out (see `task_wait_finish`)
+    const uint32_t saved_irq = task_lock(task);
+
+    if (task->signals & TASK_SIGKILL) {
+        task_unlock(task, saved_irq);
+        return KELP_KILLED;
+    }
+
+    if (by_priority) {
+        wait_queue_insert_by_priority(queue, task);
+    }
+    else {
+        wait_queue_append(queue, task);
+    }
+
+    task->resume_us = until;
+    task_set_state(task, TASK_BLOCKED);
+    task_unlock(task, saved_irq);
+    return KELP_OK;
+}
+
+kelp_error_t task_wait_prepare(wait_queue_t *queue, const absolute_time_t until) {
+    return wait_prepare(queue, until, false);
+}
+
+kelp_error_t task_wait_prepare_by_priority(wait_queue_t *queue, const absolute_time_t until) {
+    return wait_prepare(queue, until, true);
+}
+
+void wait_queue_reorder(wait_queue_t *queue, task_t *task) {
+    // it may have been taken out to be woken (or skipped as it had timed out) and not have caught up yet
+    if (task->wait_queue != queue) {
+        return;
+    }
+
+    wait_queue_unlink(queue, task);
+    wait_queue_insert_by_priority(queue, task);
+}
+
+kelp_error_t task_wait_finish(wait_queue_t *queue) {
+    task_t *task = get_current_task();
+
+    // whoever wakes a task takes it out of the queue first,
+    // so still being in it means the timeout got here first, or a kill made it ready to go
+    if (task->wait_queue == queue) {
+        wait_queue_unlink(queue, task);
+        return (task->signals & TASK_SIGKILL) ? KELP_KILLED : KELP_TIMEOUT;
+    }
+
+    // it might have been woken just as it timed out, either way its time is up
+    return time_reached(task->resume_us) ? KELP_TIMEOUT : KELP_OK;
+}
+
+void task_wait_cancel(wait_queue_t *queue) {
+    task_t *task = get_current_task();
+
+    if (task->wait_queue == queue) {
+        wait_queue_unlink(queue, task);
+    }
+
+    // it never got switched out, so whether or not someone woke it, it is still running
+    const uint32_t saved_irq = task_lock(task);
+    task_set_state(task, TASK_RUNNING);
+    task_unlock(task, saved_irq);
+}
+
+bool wait_queue_wake_one(wait_queue_t *queue) {
+    return wait_queue_wake_next(queue) != NULL;
+}
+
+task_t *wait_queue_wake_next(wait_queue_t *queue) {
+    while (queue->head != NULL) {
+        task_t *task = queue->head;
+        wait_queue_unlink(queue, task);
+
+        if (wake_task(task)) {
+            return task;
+        }
+    }
+
+    return NULL;
+}
+
+bool wait_queue_wake_task(wait_queue_t *queue, task_t *task) {
+    wait_queue_unlink(queue, task);
+    return wake_task(task);
+}
+
+uint32_t wait_queue_wake_all(wait_queue_t *queue) {
+    uint32_t woken = 0;
+
+    while (queue->head != NULL) {
+        task_t *task = queue->head;
+        wait_queue_unlink(queue, task);
+
+        if (wake_task(task)) {
+            woken++;
+        }
+    }
+
+    return woken;
+}
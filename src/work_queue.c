@@ -0,0 +1,175 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "work_queue.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "hardware/sync.h"
+#include "pico/time.h"
+#include "scheduler_internal.h"
+
+#if WORK_QUEUE
+
+#define WORK_QUEUE_MASK (WORK_QUEUE_SIZE - 1)
+
+typedef struct {
+    work_item_t items[WORK_QUEUE_SIZE];
+    volatile uint32_t head;     // where the next item goes, only its core moves it
+    volatile uint32_t tail;     // the next item to run, only its worker moves it
+    uint32_t dropped;
+} work_ring_t;
+
+typedef struct {
+    task_t *task;               // NULL until it first runs
+    volatile bool waiting;      // it found nothing to do and is (about to be) blocked
+} work_worker_t;
+
+static work_ring_t rings[CORE_COUNT];
+static work_worker_t workers[WORK_QUEUE_WORKERS];
+
+static inline work_worker_t *worker_for_core(const uint8_t core) {
+#if WORK_QUEUE_PER_CORE
+    return &workers[core];
+#else
+    return &workers[0];
+#endif
+}
+
+// run what is waiting in a ring, returns whether there was anything
+static bool ring_drain(work_ring_t *ring) {
+    uint32_t tail = ring->tail;
+
+    if (tail == ring->head) {
+        return false;
+    }
+
+    while (tail != ring->head) {
+        __dmb(); // see the item its core put in before moving `head`
+        const work_item_t item = ring->items[tail & WORK_QUEUE_MASK];
+        __dmb(); // and be done reading it before handing the slot back
+        ring->tail = ++tail;
+
+        item.function(item.arg);
+    }
+
+    return true;
+}
+
+static bool worker_rings_empty(const uint32_t index) {
+#if WORK_QUEUE_PER_CORE
+    return rings[index].tail == rings[index].head;
+#else
+    for (uint8_t c = 0; c < CORE_COUNT; c++) {
+        if (rings[c].tail != rings[c].head) {
+            return false;
+        }
+    }
+
+    return true;
+#endif
+}
+
+kelp_error_t work_queue_post(const work_function_t function, void *arg) {
+    // interrupts on this core are the only other writers, so keeping them out is enough
+    const uint32_t saved_irq = save_and_disable_interrupts();
+
+    const uint8_t core = CORE_NUM;
+    work_ring_t *ring = &rings[core];
+    const uint32_t head = ring->head;
+
+    if (head - ring->tail >= WORK_QUEUE_SIZE) {
+        ring->dropped++;
+        restore_interrupts(saved_irq);
+        return KELP_NONE_FREE;
+    }
+
+    ring->items[head & WORK_QUEUE_MASK].function = function;
+    ring->items[head & WORK_QUEUE_MASK].arg = arg;
+
+    // the item has to be in place before the worker can see it
+    __dmb();
+    ring->head = head + 1;
+
+    restore_interrupts(saved_irq);
+
+    // the worker says it is waiting before it looks at the rings a last time, and we look after posting,
+    // so either it sees the item or we see it waiting (and its run queue lock keeps the wakeup from going missing)
+    __dmb();
+    work_worker_t *worker = worker_for_core(core);
+    if (worker->waiting && worker->task != NULL) {
+        const uint32_t task_irq = task_lock(worker->task);
+        if (worker->task->state == TASK_BLOCKED) {
+            task_set_state(worker->task, TASK_READY);
+        }
+        task_unlock(worker->task, task_irq);
+    }
+
+    return KELP_OK;
+}
+
+uint32_t work_queue_dropped(const uint8_t core) {
+    if (core >= CORE_COUNT) {
+        return 0;
+    }
+
+    return rings[core].dropped;
+}
+
+void work_queue_task(uint32_t pid, uint32_t *signals, char *args) {
+    const uint32_t index = pid - WORK_QUEUE_PID;
+    work_worker_t *worker = &workers[index];
+    task_t *self = get_current_task();
+    worker->task = self;
+
+    while (true) {
+#if WORK_QUEUE_PER_CORE
+        const bool ran = ring_drain(&rings[index]);
+#else
+        bool ran = false;
+        for (uint8_t c = 0; c < CORE_COUNT; c++) {
+            ran |= ring_drain(&rings[c]);
+        }
+#endif
+
+        if (ran) {
+            continue;
+        }
+
+        // nothing to do, wait for a post to wake us
+        const uint32_t task_irq = task_lock(self);
+        worker->waiting = true;
+        __dmb();
+
+        const bool empty = worker_rings_empty(index);
+        if (empty) {
+            self->resume_us = at_the_end_of_time;
+            task_set_state(self, TASK_BLOCKED);
+        }
+        task_unlock(self, task_irq);
+
+        if (empty) {
+            scheduler_raise_pendsv();
+        }
+
+        worker->waiting = false;
+    }
+}
+
+#else
+
+kelp_error_t work_queue_post(const work_function_t function, void *arg) {
+    return KELP_NOT_SUPPORTED;
+}
+
+uint32_t work_queue_dropped(const uint8_t core) {
+    return 0;
+}
+
+void work_queue_task(uint32_t pid, uint32_t *signals, char *args) {
+    // there is no work to run
+}
+
+#endif
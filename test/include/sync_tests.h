@@ -0,0 +1,37 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#ifndef SYNC_TESTS_H
+#define SYNC_TESTS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// the synchronization cases both test suites run: test/main.c on the RP2040, and port/host/test.c under ctest
+
+#define SYNC_TEST_TIMEOUT_MS 2000   // the longest a case waits for a task it started to be gone
+
+/**
+ * How a suite shows the outcome of a case, printed after what it found
+ * @param passed whether the case passed
+ * @param format printf format of what the case found, followed by its arguments
+ */
+typedef void (*sync_test_report_t)(bool passed, const char* format, ...);
+
+/**
+ * Kill a task a case started, and wait for it to be gone
+ * @param pid the task to kill
+ * @return whether it was gone within SYNC_TEST_TIMEOUT_MS
+ */
+bool sync_test_kill(uint32_t pid);
+
+/**
+ * Run the priority inheritance, semaphore and event group, signal, software timer and work queue cases
+ * The priority inheritance case keeps its tasks on the last core, which the calling task had best stay off
+ * @param first_pid the ids from here up to `first_pid + 2` are free for the tasks the cases start
+ * @param report how to show each case
+ */
+void sync_tests_run(uint32_t first_pid, sync_test_report_t report);
+
+#endif //SYNC_TESTS_H
@@ -1,4 +1,5 @@
 #include <math.h>
+#include <stdarg.h>
 #include <hardware/gpio.h>
 #include <hardware/pwm.h>
 #include <stdio.h>
@@ -10,6 +11,7 @@
 #include "md5.h"
 #include "scheduler.h"
 #include "scheduler_internal.h"
+#include "sync_tests.h"
 
 
 void spin(const uint32_t n) {
@@ -230,6 +232,20 @@ void stack_protection_test_task(uint32_t pid) {
     printf("\n" "\e[0;32m" "SUCCESS" "\e[0m" "\n");
 }
 
+// print what a case found, followed by whether it passed
+static void test_report(const bool passed, const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    vprintf(format, args);
+    va_end(args);
+
+    if (passed) {
+        printf(" " "\e[0;32m" "SUCCESS" "\e[0m" "\n");
+    } else {
+        printf(" " "\e[0;31m" "FAIL" "\e[0m" "\n");
+    }
+}
+
 void unit_test_task(uint32_t pid) {
     printf("\nStarting Unit Tests\n");
     task_sleep_ms(1000);
@@ -237,6 +253,8 @@ void unit_test_task(uint32_t pid) {
     printf("Testing Stack Management\n");
     task_sleep_ms(1000);
 
+    sync_tests_run(pid + 2, test_report);
+
     printf("Testing Overflow Protection\n");
     const uint32_t protection_test_pid = pid + 1;
     const uint16_t initial_difficulty = 1;
@@ -305,7 +323,13 @@ void monitor_task(uint32_t pid) {
                 }
             }
 
-            printf("] %u%%\n", usage);
+            printf("] %u%%", usage);
+
+            // which cores it actually ran on
+            for (uint8_t c = 0; c < CORE_COUNT; c++) {
+                printf(" c%u: %u%%", c, task->core_usage[c]);
+            }
+            printf("\n");
         }
 
         printf("\n       --- Stack Usage ---\n");
@@ -0,0 +1,229 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+#include "sync_tests.h"
+
+#include <stdio.h>
+
+#include "pico/stdlib.h"
+#include "kernel_config.h"
+#include "counting_semaphore.h"
+#include "event_group.h"
+#include "mutex.h"
+#include "soft_timer.h"
+#include "work_queue.h"
+#include "scheduler.h"
+
+bool sync_test_kill(const uint32_t pid) {
+    task_signal(pid, TASK_SIGKILL);
+
+    for (uint32_t waited_ms = 0; task_exists(pid); waited_ms += 10) {
+        if (waited_ms >= SYNC_TEST_TIMEOUT_MS) {
+            return false;
+        }
+        task_sleep_ms(10);
+    }
+
+    return true;
+}
+
+// priority inversion: low holds the lock, high waits for it, and medium would keep low off the CPU
+#define INVERSION_CORE (CORE_COUNT - 1)
+#define INVERSION_HOLD_MS 50        // how long low holds the lock
+#define INVERSION_HOG_MS 500        // how long medium hogs the core
+#define INVERSION_LOW_PRIORITY 2
+#define INVERSION_MEDIUM_PRIORITY 5
+#define INVERSION_HIGH_PRIORITY 9
+
+static kelp_mutex_t inversion_mutex = KELP_MUTEX_INIT;
+static kelp_semaphore_t inversion_semaphore = KELP_SEMAPHORE_INIT(1, 1);  // a lock with no holder to lend priority to
+static volatile bool inversion_use_mutex;
+static volatile kelp_error_t inversion_result;
+static volatile uint32_t inversion_wait_ms;
+
+void inversion_low_task(uint32_t pid, uint32_t* signals, char* args) {
+    if (inversion_use_mutex) {
+        kelp_mutex_lock(&inversion_mutex);
+        busy_wait_ms(INVERSION_HOLD_MS);    // medium wakes up in here
+        kelp_mutex_unlock(&inversion_mutex);
+    }
+    else {
+        kelp_semaphore_take(&inversion_semaphore);
+        busy_wait_ms(INVERSION_HOLD_MS);
+        kelp_semaphore_give(&inversion_semaphore);
+    }
+}
+
+void inversion_medium_task(uint32_t pid, uint32_t* signals, char* args) {
+    task_sleep_ms(INVERSION_HOLD_MS / 5);
+    busy_wait_ms(INVERSION_HOG_MS);
+}
+
+void inversion_high_task(uint32_t pid, uint32_t* signals, char* args) {
+    task_sleep_ms(INVERSION_HOLD_MS / 10);
+
+    const uint32_t start = to_ms_since_boot(get_absolute_time());
+    if (inversion_use_mutex) {
+        inversion_result = kelp_mutex_lock_timeout(&inversion_mutex, INVERSION_HOG_MS * 2 * 1000);
+    }
+    else {
+        inversion_result = kelp_semaphore_take_timeout(&inversion_semaphore, INVERSION_HOG_MS * 2 * 1000);
+    }
+    inversion_wait_ms = to_ms_since_boot(get_absolute_time()) - start;
+
+    if (inversion_result == KELP_OK) {
+        if (inversion_use_mutex) {
+            kelp_mutex_unlock(&inversion_mutex);
+        }
+        else {
+            kelp_semaphore_give(&inversion_semaphore);
+        }
+    }
+}
+
+// how long high waits for the lock, or UINT32_MAX if it never got it
+static uint32_t test_inversion(const uint32_t first_pid, const bool use_mutex) {
+    const uint32_t low_pid = first_pid;
+    const uint32_t medium_pid = first_pid + 1;
+    const uint32_t high_pid = first_pid + 2;
+    inversion_use_mutex = use_mutex;
+    inversion_result = KELP_ERROR;
+
+    // all on one core, so nothing but priorities decides who runs
+    task_add_affinity(inversion_low_task, low_pid, INVERSION_LOW_PRIORITY, TASK_CORE(INVERSION_CORE));
+    task_add_affinity(inversion_high_task, high_pid, INVERSION_HIGH_PRIORITY, TASK_CORE(INVERSION_CORE));
+    task_add_affinity(inversion_medium_task, medium_pid, INVERSION_MEDIUM_PRIORITY, TASK_CORE(INVERSION_CORE));
+
+    while (task_exists(low_pid) || task_exists(medium_pid) || task_exists(high_pid)) {
+        task_sleep_ms(10);
+    }
+
+    return inversion_result == KELP_OK ? inversion_wait_ms : UINT32_MAX;
+}
+
+// without inheritance high waits for medium to finish hogging, with it only for low to finish holding the lock
+static void test_priority_inheritance(const uint32_t first_pid, const sync_test_report_t report) {
+    printf("Testing Priority Inheritance\n");
+    const uint32_t mutex_ms = test_inversion(first_pid, true);
+    const uint32_t semaphore_ms = test_inversion(first_pid, false);
+
+    report(mutex_ms < INVERSION_HOG_MS / 2 && semaphore_ms != UINT32_MAX && semaphore_ms >= INVERSION_HOG_MS / 2,
+           "High priority task waited %lums for the mutex, %lums for a semaphore", (unsigned long)mutex_ms,
+           (unsigned long)semaphore_ms);
+}
+
+// the producer gives every unit and sets a flag once it is done, the test blocks on both instead of polling
+#define PRODUCER_UNITS 100
+#define PRODUCER_DONE (1 << 0)
+#define PRODUCER_PRIORITY 6
+
+static kelp_semaphore_t producer_semaphore = KELP_SEMAPHORE_INIT(0, PRODUCER_UNITS);
+static kelp_event_group_t producer_events = KELP_EVENT_GROUP_INIT;
+
+void producer_task(uint32_t pid, uint32_t* signals, char* args) {
+    for (uint32_t u = 0; u < PRODUCER_UNITS; u++) {
+        kelp_semaphore_give(&producer_semaphore);
+
+        if (u % 10 == 0) {
+            task_sleep_ms(1);   // make the taker block now and then
+        }
+    }
+
+    kelp_event_group_set(&producer_events, PRODUCER_DONE);
+}
+
+static void test_semaphores_and_events(const uint32_t first_pid, const sync_test_report_t report) {
+    printf("Testing Semaphores and Event Groups\n");
+    task_add_affinity(producer_task, first_pid, PRODUCER_PRIORITY, TASK_ANY_CORE);
+
+    uint32_t units = 0;
+    while (units < PRODUCER_UNITS && kelp_semaphore_take_timeout(&producer_semaphore, 100 * 1000) == KELP_OK) {
+        units++;
+    }
+
+    const kelp_error_t done = kelp_event_group_wait_timeout(&producer_events, PRODUCER_DONE, KELP_EVENT_CLEAR,
+                                                            100 * 1000, NULL);
+
+    report(units == PRODUCER_UNITS && done == KELP_OK && kelp_event_group_get(&producer_events) == 0,
+           "Took %lu units (%d)", (unsigned long)units, done);
+    sync_test_kill(first_pid);
+}
+
+#define SIGNAL_WAITER_PRIORITY 8
+
+static volatile uint32_t signal_received;
+
+void signal_waiter_task(uint32_t pid, uint32_t* signals, char* args) {
+    signal_received = task_wait_signals(TASK_SIGUSR1, 1000 * 1000);
+    task_take_signals(TASK_SIGUSR1);
+
+    // parked until the test kills it
+    task_wait_signals(TASK_SIGUSR2, TASK_WAIT_FOREVER);
+}
+
+static void test_signals(const uint32_t first_pid, const sync_test_report_t report) {
+    printf("Testing Signals\n");
+    signal_received = 0;
+    task_add_affinity(signal_waiter_task, first_pid, SIGNAL_WAITER_PRIORITY, TASK_ANY_CORE);
+    task_sleep_ms(10);
+
+    task_signal(first_pid, TASK_SIGUSR1);
+    task_sleep_ms(10);
+    const bool killed = sync_test_kill(first_pid);
+
+    report(signal_received == TASK_SIGUSR1 && killed, "Received %lu", (unsigned long)signal_received);
+}
+
+static void count_timer_callback(kelp_timer_t* timer, void* arg) {
+    (*(volatile uint32_t*)arg)++;
+}
+
+static void test_soft_timers(const sync_test_report_t report) {
+    printf("Testing Software Timers\n");
+    static volatile uint32_t periodic_count = 0;
+    static volatile uint32_t one_shot_count = 0;
+    kelp_timer_t periodic_timer;
+    kelp_timer_t one_shot_timer;
+
+    kelp_timer_init(&periodic_timer, count_timer_callback, (void*)&periodic_count, 10 * 1000, true);
+    kelp_timer_init(&one_shot_timer, count_timer_callback, (void*)&one_shot_count, 50 * 1000, false);
+    kelp_timer_start(&periodic_timer);
+    kelp_timer_start(&one_shot_timer);
+
+    task_sleep_ms(205);
+    kelp_timer_stop(&periodic_timer);
+
+    // 20 periods, give or take a tick at either end
+    report(periodic_count >= 19 && periodic_count <= 21 && one_shot_count == 1 &&
+           !kelp_timer_is_active(&one_shot_timer),
+           "Periodic %lu, one-shot %lu", (unsigned long)periodic_count, (unsigned long)one_shot_count);
+}
+
+static void count_work(void* arg) {
+    (*(volatile uint32_t*)arg)++;
+}
+
+static void test_work_queue(const sync_test_report_t report) {
+    printf("Testing Work Queue\n");
+    static volatile uint32_t work_count = 0;
+    uint32_t posted = 0;
+
+    for (uint32_t w = 0; w < WORK_QUEUE_SIZE; w++) {
+        if (work_queue_post(count_work, (void*)&work_count) == KELP_OK) {
+            posted++;
+        }
+    }
+    task_sleep_ms(10);
+
+    report(posted == WORK_QUEUE_SIZE && work_count == posted, "Posted %lu, ran %lu", (unsigned long)posted,
+           (unsigned long)work_count);
+}
+
+void sync_tests_run(const uint32_t first_pid, const sync_test_report_t report) {
+    test_priority_inheritance(first_pid, report);
+    test_semaphores_and_events(first_pid, report);
+    test_signals(first_pid, report);
+    test_soft_timers(report);
+    test_work_queue(report);
+}
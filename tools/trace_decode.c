@@ -0,0 +1,221 @@
+//
+// Created by wolfboy on 10/17/2026.
+//
+
+// turns the output of `trace_stream_task` into a Chrome trace (JSON), for Perfetto or chrome://tracing
+// every line that isn't trace output is skipped, so a whole serial log can be fed in:
+//     trace_decode < serial.log > trace.json
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "trace.h"
+
+#define MAX_CORES 8
+
+// matches `task_state_t` in scheduler_internal.h
+static const char* state_names[] = {
+    "free", "claimed", "running", "ready", "suspended", "stack overflowed",
+    "sleeping", "blocked", "yielding", "zombie", "dead", "stopped"
+};
+
+static const char* housekeeping_names[] = {
+    "stack usage", "channels", "cpu usage", "tasks", "governor"
+};
+
+typedef struct {
+    uint32_t last_us;
+    uint64_t epoch_us;      // added on every time the 32-bit timer wrapped
+    uint32_t running;       // the task whose slice is open, if `has_running`
+    bool has_running;
+    uint64_t now_us;
+} core_t;
+
+static core_t cores[MAX_CORES];
+static bool first_event = true;
+
+static const char* state_name(const uint32_t state) {
+    if (state < sizeof(state_names) / sizeof(state_names[0])) {
+        return state_names[state];
+    }
+
+    return "unknown";
+}
+
+static void begin_event() {
+    printf(first_event ? "\n" : ",\n");
+    first_event = false;
+}
+
+static void print_task_name(const uint32_t id) {
+    if (id == TRACE_NO_TASK) {
+        printf("none");
+    }
+    else {
+        printf("task %u", id);
+    }
+}
+
+// a thread per core, so each core's track shows which task it ran
+static void slice(const char phase, const unsigned core, const uint64_t ts, const uint32_t task) {
+    begin_event();
+    printf("{\"ph\": \"%c\", \"pid\": 0, \"tid\": %u, \"ts\": %llu, \"name\": \"", phase, core,
+           (unsigned long long)ts);
+    print_task_name(task);
+    printf("\"}");
+}
+
+static void instant(const unsigned core, const uint64_t ts, const char* name) {
+    begin_event();
+    printf("{\"ph\": \"i\", \"s\": \"t\", \"pid\": 0, \"tid\": %u, \"ts\": %llu, \"name\": \"%s\", \"args\": {",
+           core, (unsigned long long)ts, name);
+}
+
+static void decode(const unsigned core, const uint32_t time_us, const unsigned type, const unsigned detail,
+                   const unsigned value, const uint32_t a, const uint32_t b) {
+    core_t* c = &cores[core];
+
+    // the timer is 64 bits on the chip, but only the low 32 are recorded
+    if (time_us < c->last_us && c->last_us - time_us > 0x80000000u) {
+        c->epoch_us += 0x100000000ull;
+    }
+    c->last_us = time_us;
+    const uint64_t ts = c->epoch_us + time_us;
+    c->now_us = ts;
+
+    switch (type) {
+        case TRACE_START:
+            instant(core, ts, "start");
+            printf("}}");
+            break;
+
+        case TRACE_SWITCH:
+            if (c->has_running) {
+                slice('E', core, ts, c->running);
+            }
+            slice('B', core, ts, b);
+            c->running = b;
+            c->has_running = true;
+            break;
+
+        case TRACE_STATE:
+            instant(core, ts, state_name(detail));
+            printf("\"task\": %u, \"from\": \"%s\"}}", a, state_name(value));
+            break;
+
+        case TRACE_WAKE:
+            instant(core, ts, "wake");
+            printf("\"task\": %u, \"core\": %u, \"by\": ", a, detail);
+            if (b == TRACE_NO_TASK) {
+                printf("\"timer\"}}");
+            }
+            else {
+                printf("%u}}", b);
+            }
+            break;
+
+        case TRACE_CHANNEL_CONNECT:
+            instant(core, ts, "channel connect");
+            printf("\"channel\": %u, \"owner\": %u, \"partner\": %u}}", value, a, b);
+            break;
+
+        case TRACE_CHANNEL_FREE:
+            instant(core, ts, "channel free");
+            printf("\"channel\": %u}}", value);
+            break;
+
+        case TRACE_CHANNEL_WRITE:
+            instant(core, ts, "channel write");
+            printf("\"channel\": %u, \"size\": %u}}", value, a);
+            break;
+
+        case TRACE_CHANNEL_READ:
+            instant(core, ts, "channel read");
+            printf("\"channel\": %u, \"size\": %u}}", value, a);
+            break;
+
+        case TRACE_STACK_RESIZE:
+            instant(core, ts, "stack resize");
+            printf("\"task\": %u, \"from\": %u, \"to\": %u}}", a, value, b);
+            break;
+
+        case TRACE_CLOCK:
+            begin_event();
+            printf("{\"ph\": \"C\", \"pid\": 0, \"ts\": %llu, \"name\": \"clk_sys\", \"args\": {\"MHz\": %.3f}}",
+                   (unsigned long long)ts, a / 1000.0);
+            break;
+
+        case TRACE_HOUSEKEEPING:
+            begin_event();
+            printf("{\"ph\": \"X\", \"pid\": 0, \"tid\": %u, \"ts\": %llu, \"dur\": %u, \"name\": \"housekeeping\", "
+                   "\"args\": {\"ran\": \"", core, (unsigned long long)(ts - a), a);
+            bool first = true;
+            for (unsigned h = 0; h < sizeof(housekeeping_names) / sizeof(housekeeping_names[0]); h++) {
+                if (detail & (1u << h)) {
+                    printf("%s%s", first ? "" : ", ", housekeeping_names[h]);
+                    first = false;
+                }
+            }
+            printf("\"}}");
+            break;
+
+        default:
+            instant(core, ts, "unknown");
+            printf("\"type\": %u}}", type);
+            break;
+    }
+}
+
+int main() {
+    char line[256];
+    unsigned max_core = 0;
+
+    printf("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [");
+
+    while (fgets(line, sizeof(line), stdin) != NULL) {
+        // the serial port may put something in front of a line
+        const char* start = strstr(line, "@T ");
+        if (start == NULL) {
+            start = strstr(line, "@D ");
+        }
+        if (start == NULL) {
+            continue;
+        }
+
+        unsigned core, type, detail, value;
+        unsigned long time_us, a, b, dropped;
+
+        if (sscanf(start, "@T %u %lu %u %u %u %lu %lu", &core, &time_us, &type, &detail, &value, &a, &b) == 7) {
+            if (core >= MAX_CORES) {
+                continue;
+            }
+            if (core > max_core) {
+                max_core = core;
+            }
+            decode(core, (uint32_t)time_us, type, detail, value, (uint32_t)a, (uint32_t)b);
+        }
+        else if (sscanf(start, "@D %u %lu", &core, &dropped) == 2 && core < MAX_CORES) {
+            instant(core, cores[core].now_us, "events dropped");
+            printf("\"total\": %lu}}", dropped);
+        }
+    }
+
+    // close the slices still open, and name the tracks
+    for (unsigned c = 0; c <= max_core; c++) {
+        if (cores[c].has_running) {
+            slice('E', c, cores[c].now_us, cores[c].running);
+        }
+
+        begin_event();
+        printf("{\"ph\": \"M\", \"pid\": 0, \"tid\": %u, \"name\": \"thread_name\", \"args\": {\"name\": \"core %u\"}}",
+               c, c);
+    }
+
+    begin_event();
+    printf("{\"ph\": \"M\", \"pid\": 0, \"name\": \"process_name\", \"args\": {\"name\": \"kernel\"}}");
+    printf("\n]}\n");
+
+    return 0;
+}